@@ -0,0 +1,213 @@
+/* trace2json.c
+ *
+ * This program reads a Nachos event trace (made with "nachos -trace
+ * <file>") and writes it out in the Chrome trace event format, which
+ * chrome://tracing and Perfetto display as a timeline:
+ *
+ *	trace2json nachos.trace > nachos.json
+ *
+ * The timeline has these tracks:
+ *	"cpu"		-- which thread holds the CPU, one slice per turn
+ *	"interrupts"	-- a mark for each interrupt, with how late it was
+ *	"disk"		-- one slice per disk request, from request to done
+ *	"thread <n>"	-- thread n's system calls, as slices, plus marks
+ *			   where it was made ready, or took a page fault
+ *			   or TLB miss
+ *
+ * The record layout and event numbers must match machine/trace.h.
+ *
+ * Copyright (c) 1992-1993 The Regents of the University of California.
+ * All rights reserved.  See copyright.h for copyright notice and limitation
+ * of liability and disclaimer of warranty provisions.
+ */
+
+#define MAIN
+#include "copyright.h"
+#undef MAIN
+
+#include <stdio.h>
+#include <stdlib.h>
+
+/* as in machine/trace.h */
+enum TraceEvent { TraceSwitch, TraceReady, TraceInterrupt, TracePageFault,
+	TraceTlbMiss, TraceDiskRequest, TraceDiskDone, TraceSyscallEnter,
+	TraceSyscallExit };
+
+typedef struct {
+    int time;
+    short type;
+    short thread;
+    int arg1, arg2;
+} TraceRecord;
+
+typedef struct {
+    int magic;
+    int version;
+    int recordSize;
+    int tickNanos;
+} TraceFileHeader;
+
+#define TraceMagic	0x4352544e
+#define TraceVersion	1
+
+/* as IntType in machine/interrupt.h */
+static char *intNames[] = { "timer", "disk", "console write",
+	"console read", "network send", "network recv", "retransmit" };
+#define NumIntNames	(sizeof(intNames) / sizeof(intNames[0]))
+
+/* as the SC_ codes in userprog/syscall.h */
+static char *syscallNames[] = { "Halt", "Exit", "Exec", "Join", "Create",
+	"Open", "Read", "Write", "Close", "Fork", "Yield", "Pwd", "Ls", "Cd",
+	"Pipe", "PRead", "PWrite", "ReadV", "WriteV", "GetUsage" };
+#define NumSyscallNames	(sizeof(syscallNames) / sizeof(syscallNames[0]))
+
+/* tracks in the "kernel" process (pid 0); threads are in pid 1 */
+#define CpuTrack	0
+#define InterruptTrack	1
+#define DiskTrack	2
+
+#define MaxThreads	4096	/* thread ids we keep track of */
+
+static double usecPerTick;
+static int first = 1;		/* no event printed yet? */
+static char seen[MaxThreads];	/* thread's track named yet? */
+
+/* start an event: everything up to the end of the "ts" field */
+static void
+Event(char *phase, int pid, int tid, int time)
+{
+    printf("%s\n  {\"ph\":\"%s\",\"pid\":%d,\"tid\":%d,\"ts\":%.3f",
+	first ? "" : ",", phase, pid, tid, time * usecPerTick);
+    first = 0;
+}
+
+/* name a track */
+static void
+TrackName(int pid, int tid, char *name, int number)
+{
+    Event("M", pid, tid, 0);
+    printf(",\"name\":\"thread_name\",\"args\":{\"name\":\"%s", name);
+    if (number >= 0)
+	printf(" %d", number);
+    printf("\"}}");
+}
+
+/* the track of thread "tid", named the first time it is used */
+static int
+ThreadTrack(int tid)
+{
+    if (tid >= 0 && tid < MaxThreads && !seen[tid]) {
+	seen[tid] = 1;
+	TrackName(1, tid, "thread", tid);
+    }
+    return tid;
+}
+
+static char *
+SyscallName(int code)
+{
+    static char name[32];
+
+    if (code >= 0 && code < NumSyscallNames)
+	return syscallNames[code];
+    sprintf(name, "syscall %d", code);
+    return name;
+}
+
+int
+main(int argc, char **argv)
+{
+    FILE *in;
+    TraceFileHeader hdr;
+    TraceRecord rec;
+    int running = -1;		/* thread on the CPU track, if known */
+    int lastTime = 0;
+    long count = 0;
+
+    if (argc != 2) {
+	fprintf(stderr, "Usage: %s <nachos trace file>\n", argv[0]);
+	exit(1);
+    }
+    if ((in = fopen(argv[1], "rb")) == NULL) {
+	perror(argv[1]);
+	exit(1);
+    }
+    if (fread(&hdr, sizeof(hdr), 1, in) != 1 || hdr.magic != TraceMagic
+		|| hdr.version != TraceVersion
+		|| hdr.recordSize != sizeof(TraceRecord)) {
+	fprintf(stderr, "%s: not a Nachos trace file (or from another host)\n",
+		argv[1]);
+	exit(1);
+    }
+    usecPerTick = hdr.tickNanos / 1000.0;
+
+    printf("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[");
+    Event("M", 0, 0, 0);
+    printf(",\"name\":\"process_name\",\"args\":{\"name\":\"kernel\"}}");
+    Event("M", 1, 0, 0);
+    printf(",\"name\":\"process_name\",\"args\":{\"name\":\"threads\"}}");
+    TrackName(0, CpuTrack, "cpu", -1);
+    TrackName(0, InterruptTrack, "interrupts", -1);
+    TrackName(0, DiskTrack, "disk", -1);
+
+    while (fread(&rec, sizeof(rec), 1, in) == 1) {
+	count++;
+	lastTime = rec.time;
+	switch (rec.type) {
+	  case TraceSwitch:
+	    if (running >= 0) {
+		Event("E", 0, CpuTrack, rec.time);
+		printf("}");
+	    }
+	    Event("B", 0, CpuTrack, rec.time);
+	    printf(",\"name\":\"thread %d\"}", rec.arg2);
+	    running = rec.arg2;
+	    break;
+	  case TraceReady:
+	    Event("i", 1, ThreadTrack(rec.arg1), rec.time);
+	    printf(",\"s\":\"t\",\"name\":\"ready\"}");
+	    break;
+	  case TraceInterrupt:
+	    Event("i", 0, InterruptTrack, rec.time);
+	    printf(",\"s\":\"t\",\"name\":\"%s\",\"args\":{\"late\":%d}}",
+		(rec.arg1 >= 0 && rec.arg1 < NumIntNames) ?
+			intNames[rec.arg1] : "interrupt", rec.arg2);
+	    break;
+	  case TracePageFault:
+	  case TraceTlbMiss:
+	    Event("i", 1, ThreadTrack(rec.thread), rec.time);
+	    printf(",\"s\":\"t\",\"name\":\"%s\",\"args\":{\"vaddr\":%d}}",
+		(rec.type == TracePageFault) ? "page fault" : "TLB miss",
+		rec.arg1);
+	    break;
+	  case TraceDiskRequest:
+	    Event("B", 0, DiskTrack, rec.time);
+	    printf(",\"name\":\"%s\",\"args\":{\"sector\":%d}}",
+		rec.arg2 ? "write" : "read", rec.arg1);
+	    break;
+	  case TraceDiskDone:
+	    Event("E", 0, DiskTrack, rec.time);
+	    printf("}");
+	    break;
+	  case TraceSyscallEnter:
+	    Event("B", 1, ThreadTrack(rec.thread), rec.time);
+	    printf(",\"name\":\"%s\"}", SyscallName(rec.arg1));
+	    break;
+	  case TraceSyscallExit:
+	    Event("E", 1, ThreadTrack(rec.thread), rec.time);
+	    printf(",\"args\":{\"result\":%d}}", rec.arg2);
+	    break;
+	  default:			/* from a newer Nachos; skip it */
+	    break;
+	}
+    }
+    if (running >= 0) {
+	Event("E", 0, CpuTrack, lastTime);
+	printf("}");
+    }
+    printf("\n]}\n");
+
+    fprintf(stderr, "%ld events\n", count);
+    fclose(in);
+    return 0;
+}
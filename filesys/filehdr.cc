@@ -341,7 +341,7 @@ bool FileHeader::ExtendLen(BitMap* freeMap, int bytes) {
     if(freeMap->NumClear() < numSectors - initNumSectors) // not enough disk sectors
         return FALSE;
 
-    printf("Extending %d sectors\n", numSectors - initNumSectors);
+    LOG(LogVerbose, "Extending %d sectors\n", numSectors - initNumSectors);
 
     if(numSectors < NumDirect) { // no need to use indirect index
         for (int i = initNumSectors; i < numSectors; i++)
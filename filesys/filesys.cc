@@ -84,20 +84,16 @@
 
 FileSystem::FileSystem(bool format)
 {
-// anything about pipe is for L5C2
-
     DEBUG('f', "Initializing the file system.\n");
     if (format) {
         BitMap *freeMap = new BitMap(NumSectors);
         Directory *directory = new Directory(NumDirEntries);
 	      FileHeader *mapHdr = new FileHeader;
 	      FileHeader *dirHdr = new FileHeader;
-        FileHeader *pipeHdr = new FileHeader;
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 // for L5E2
         mapHdr->setSectorNum(0);
         dirHdr->setSectorNum(1);
-        pipeHdr->setSectorNum(2);
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
         DEBUG('f', "Formatting the file system.\n");
@@ -106,14 +102,12 @@ FileSystem::FileSystem(bool format)
     // (make sure no one else grabs these!)
 	      freeMap->Mark(FreeMapSector);
 	      freeMap->Mark(DirectorySector);
-        freeMap->Mark(PipeSector);
 
     // Second, allocate space for the data blocks containing the contents
     // of the directory and bitmap files.  There better be enough space!
 
 	      ASSERT(mapHdr->Allocate(freeMap, FreeMapFileSize));
 	      ASSERT(dirHdr->Allocate(freeMap, DirectoryFileSize));
-        ASSERT(pipeHdr->Allocate(freeMap, PipeFileSize));
 
     // Flush the bitmap and directory FileHeaders back to disk
     // We need to do this before we can "Open" the file, since open
@@ -123,7 +117,6 @@ FileSystem::FileSystem(bool format)
         DEBUG('f', "Writing headers back to disk.\n");
 	      mapHdr->WriteBack(FreeMapSector);
 	      dirHdr->WriteBack(DirectorySector);
-        pipeHdr->WriteBack(PipeSector);
 
     // OK to open the bitmap and directory files now
     // The file system operations assume these two files are left open
@@ -131,7 +124,6 @@ FileSystem::FileSystem(bool format)
 
         freeMapFile = new OpenFile(FreeMapSector);
         directoryFile = new OpenFile(DirectorySector);
-        pipeFile = new OpenFile(PipeSector);
 
     // Once we have the files "open", we can write the initial version
     // of each file back to disk.  The directory at this point is completely
@@ -151,14 +143,12 @@ FileSystem::FileSystem(bool format)
 	         delete directory;
 	         delete mapHdr;
 	         delete dirHdr;
-           delete pipeHdr;
 	       }
     } else {
     // if we are not formatting the disk, just open the files representing
     // the bitmap and directory; these are left open while Nachos is running
           freeMapFile = new OpenFile(FreeMapSector);
           directoryFile = new OpenFile(DirectorySector);
-          pipeFile = new OpenFile(PipeSector);
     }
 }
 
@@ -283,14 +273,14 @@ FileSystem::Create(char *name, int initialSize)
         return FALSE;		// no free block for file header
 
     if(initialSize == -1) { // creating directory
-        printf("Creating dir: %s\n", name);
+        LOG(LogInfo, "Creating dir: %s\n", name);
         type = 0;
         if(!directory->Add(name, sector, 0))
             return FALSE;
         initialSize = DirectoryFileSize;
     }
     else { // creating file
-        printf("Creating file: %s\n", name);
+        LOG(LogInfo, "Creating file: %s\n", name);
         type = 1;
         if(!directory->Add(name, sector, 1))
             return FALSE;
@@ -327,7 +317,7 @@ FileSystem::Create(char *name, int initialSize)
     delete freeMap;
     delete directory;
 
-    printf("Created successfully.\n");
+    LOG(LogInfo, "Created successfully.\n");
     return success;
 }
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
@@ -427,14 +417,14 @@ FileSystem::Remove(char *name)
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     //printf("Thread '%s' tries to remove file.\n", currentThread->getName());
     if(synchDisk->numVisitor[sector]) {
-        printf("File being used by other threads. Unable to remove.\n");
+        LOG(LogError, "File being used by other threads. Unable to remove.\n");
         return FALSE;
     }
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     if(directory->GetType(fileName) == 0) { // if dir, delete all the files it contains
-        printf("Deleing dir: %s...\n", name);
+        LOG(LogInfo, "Deleing dir: %s...\n", name);
         Directory *delDir = new Directory(NumDirEntries);
         OpenFile *delOpenFile = new OpenFile(sector);
         delDir->FetchFrom(delOpenFile); // deleting dir
@@ -450,7 +440,7 @@ FileSystem::Remove(char *name)
         delete delDir;
         delete delOpenFile;
     } else {
-        printf("Deleting file: %s...\n", name);
+        LOG(LogInfo, "Deleting file: %s...\n", name);
     }
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
@@ -475,7 +465,7 @@ FileSystem::Remove(char *name)
     delete freeMap;
     delete openFile;
 
-    printf("Deleted successfully.\n");
+    LOG(LogInfo, "Deleted successfully.\n");
 
     return TRUE;
 }
@@ -554,82 +544,4 @@ char* FileSystem::GetFileName(char* name) {
     fileName[j] = '\0';
     return fileName;
 }
-
-// for L5C2
-int FileSystem::ReadPipe(char* data) {
-
-    FileHeader *hdr;
-    hdr = new FileHeader;
-    hdr->FetchFrom(PipeSector);
-
-    printf("\n");
-    hdr->Print();
-    printf("\n");
-
-    OpenFile *pipeFile = new OpenFile(PipeSector);
-    int len = hdr->getNumBytes();
-    printf("Reading data from pipe...\n");
-    pipeFile->Read(data, len);
-
-    delete pipeFile;
-    delete hdr;
-    return len;
-}
-
-void FileSystem::WritePipe(char* data, int len) {
-
-    FileHeader *hdr;
-    hdr = new FileHeader;
-    OpenFile *pipeFile = new OpenFile(PipeSector);
-
-    printf("Writing data to pipe...\n");
-    pipeFile->Write(data, len);
-
-    hdr->FetchFrom(PipeSector);
-    hdr->setNumBytes(len);
-    hdr->WriteBack(PipeSector);
-
-    delete pipeFile;
-    delete hdr;
-}
-
-void FileSystem::WriteToPipe(char* data, int length, int from, int to) {
-    printf("\nWriting to pipe...\n");
-    char name[20];
-    sprintf(name, "pipe_%d_%d", from, to);
-
-    ASSERT(Create(name, 128) == TRUE);
-    OpenFile *pipeFile = Open(name);
-    int sectorNum = pipeFile->sectorNum;
-
-    pipeFile->Write(data, length);
-    FileHeader *hdr = new FileHeader;
-    hdr->FetchFrom(sectorNum);
-    hdr->setNumBytes(length);
-    hdr->WriteBack(sectorNum);
-
-    delete pipeFile;
-    delete hdr;
-}
-
-int FileSystem::ReadFromPipe(char* data, int from, int to) {
-    printf("Reading from pipe...\n");
-    char name[20];
-    sprintf(name, "pipe_%d_%d", from, to);
-
-    OpenFile *pipeFile = Open(name);
-    ASSERT(pipeFile != NULL);
-    int sectorNum = pipeFile->sectorNum;
-
-    FileHeader *hdr = new FileHeader;
-    hdr->FetchFrom(sectorNum);
-    int length = hdr->getNumBytes();
-    pipeFile->Read(data, length);
-    printf("data: %s\n", data);
-    delete pipeFile;
-    delete hdr;
-    Remove(name);
-
-    return length;
-}
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
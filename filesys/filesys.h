@@ -45,7 +45,6 @@
 // sectors, so that they can be located on boot-up.
 #define FreeMapSector 		0
 #define DirectorySector 	1
-#define PipeSector        2
 
 // Initial file sizes for the bitmap and directory; until the file system
 // supports extensible files, the directory size sets the maximum number
@@ -53,7 +52,6 @@
 #define FreeMapFileSize 	(NumSectors / BitsInByte)
 #define NumDirEntries 		10
 #define DirectoryFileSize 	(sizeof(DirectoryEntry) * NumDirEntries)
-#define PipeFileSize      0
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 
@@ -108,11 +106,7 @@ class FileSystem {
 // for L5E4
     char* GetFileName(char* name);
 
-// for L5C2
-    int ReadPipe(char* data);
-    void WritePipe(char* data, int len);
-    void WriteToPipe(char* data, int length, int from, int to);
-    int ReadFromPipe(char* data, int from, int to);
+// for L5C2: pipes are kernel SynchPipes now (synchpipe.h), not files
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 
@@ -122,11 +116,6 @@ class FileSystem {
    OpenFile* directoryFile;		// "Root" directory -- list of
 					// file names, represented as a file
 
-/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
-// for L5C2
-   OpenFile* pipeFile;
-/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
-
 };
 
 #endif // FILESYS
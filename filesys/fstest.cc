@@ -20,6 +20,7 @@
 #include "thread.h"
 #include "disk.h"
 #include "stats.h"
+#include "synchpipe.h"
 
 
 #define TransferSize 	10 	// make it small, just to be difficult
@@ -240,6 +241,10 @@ void ReaderWriterTest() {
 }
 
 // for L5C2
+// -wp and -rp share one kernel pipe, so give both in the same run
+// ("nachos -wp -rp"); the pipe holds up to PipeSize bytes.
+static SynchPipe *consolePipe = NULL;
+
 void ConsoleToPipe() {
     printf("\nThread 1 writes to pipe.\n");
 
@@ -247,26 +252,47 @@ void ConsoleToPipe() {
     printf("Input:\n");
     scanf("%s", input);
 
-    fileSystem->WritePipe(input, strlen(input));
+    if (consolePipe == NULL)
+        consolePipe = new SynchPipe("console pipe");
+    else
+        consolePipe->OpenEnd(TRUE);
+    printf("Writing data to pipe...\n");
+    consolePipe->Write(input, strlen(input));
+    if (consolePipe->CloseEnd(TRUE)) {	// done: a reader won't wait
+        delete consolePipe;		// for more
+        consolePipe = NULL;
+    }
 }
 
 void PipeToConsole() {
     printf("\nThread 2 reads from pipe.\n");
 
-    char output[SectorSize];
-    int len = fileSystem->ReadPipe(output);
+    char output[SectorSize + 1];
+    int len = 0;
+    if (consolePipe != NULL) {
+        printf("Reading data from pipe...\n");
+        len = consolePipe->Read(output, SectorSize);
+        if (consolePipe->CloseEnd(FALSE)) {
+            delete consolePipe;
+            consolePipe = NULL;
+        }
+    }
     output[len] = '\0';
 
     printf("Output:\n%s\n\n", output);
 }
 
 void PipeTestChild(int arg) {
+    SynchPipe *pipe = (SynchPipe *)arg;
     printf("\nThread 1 communicates with Thread 0.\n");
     printf("Thread 1 reads data from the pipe.\n");
 
     char data[SectorSize + 1];
-    int len = fileSystem->ReadFromPipe(data, 0, currentThread->getThreadID());
+    int len = pipe->Read(data, SectorSize);
+    data[len] = '\0';
     printf("\noutput: %s\n", data);
+    if (pipe->CloseEnd(FALSE))
+        delete pipe;
 }
 
 void PipeTest() {
@@ -276,11 +302,12 @@ void PipeTest() {
     printf("Input: ");
     scanf("%s", input);
 
+    SynchPipe *pipe = new SynchPipe("test pipe");
     Thread* thread = new Thread("child");
-    int from = currentThread->getThreadID();
-    int to = thread->getThreadID();
-    fileSystem->WriteToPipe(input, strlen(input), from, to);
-    thread->Fork(PipeTestChild, 0);
+    thread->Fork(PipeTestChild, (int)pipe);
+    pipe->Write(input, strlen(input));
+    if (pipe->CloseEnd(TRUE))
+        delete pipe;
     currentThread->Yield();
 }
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
@@ -53,6 +53,20 @@ OpenFile::~OpenFile()
     delete hdr;
 }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// OpenFile::HeaderSector
+// 	Return the sector holding this file's header.  No two files
+//	share it, so it names the file (e.g. for sharing text pages).
+//----------------------------------------------------------------------
+
+int
+OpenFile::HeaderSector()
+{
+    return hdr->getSectorNum();
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 //----------------------------------------------------------------------
 // OpenFile::Seek
 // 	Change the current location within the open file -- the point at
@@ -159,6 +173,10 @@ OpenFile::ReadAt(char *into, int numBytes, int position)
     firstSector = divRoundDown(position, SectorSize);
     lastSector = divRoundDown(position + numBytes - 1, SectorSize);
     numSectors = 1 + lastSector - firstSector;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    int oldFile = currentThread->ioFile;	// charge the disk requests
+    currentThread->ioFile = hdr->getSectorNum();	// to us
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     // read in all the full and partial sectors that we need
     buf = new char[numSectors * SectorSize];
@@ -172,6 +190,7 @@ OpenFile::ReadAt(char *into, int numBytes, int position)
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     hdr->setLastVisitedTime();
     hdr->WriteBack(hdr->getSectorNum());
+    currentThread->ioFile = oldFile;
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     delete [] buf;
@@ -191,6 +210,8 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
     //    return 0;				// check request
     if ((numBytes <= 0))
         return 0;				// check request
+    int oldFile = currentThread->ioFile;	// charge the disk requests
+    currentThread->ioFile = hdr->getSectorNum();	// to us
     if ((position + numBytes) > fileLength) {
         //numBytes = fileLength - position;
         OpenFile* freeMapFile = new OpenFile(FreeMapSector);
@@ -235,6 +256,7 @@ OpenFile::WriteAt(char *from, int numBytes, int position)
     hdr->setLastVisitedTime();
     hdr->setLastModifiedTime();
     hdr->WriteBack(hdr->getSectorNum());
+    currentThread->ioFile = oldFile;
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     delete [] buf;
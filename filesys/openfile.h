@@ -53,6 +53,11 @@ class OpenFile {
 
     int Length() { Lseek(file, 0, 2); return Tell(file); }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    int HeaderSector() { return FileNumber(file); }	// the UNIX inode
+					// stands in for the header sector
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
   private:
     int file;
     int currentOffset;
@@ -88,6 +93,8 @@ class OpenFile {
 
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     int sectorNum;
+    int HeaderSector();			// Disk sector of the file header;
+					// identifies the file while open
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
   private:
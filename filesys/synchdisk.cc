@@ -99,6 +99,9 @@ SynchDisk::ReadSector(int sectorNumber, char* data)
     disk->ReadRequest(sectorNumber, data);
     semaphore->P();			// wait for interrupt
     lock->Release();
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    currentThread->usage.numSectorsRead++;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 // // for L5C1b
@@ -183,6 +186,9 @@ SynchDisk::WriteSector(int sectorNumber, char* data)
     disk->WriteRequest(sectorNumber, data);
     semaphore->P();			// wait for interrupt
     lock->Release();
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    currentThread->usage.numSectorsWritten++;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 }
 
 //----------------------------------------------------------------------
@@ -0,0 +1,146 @@
+// synchpipe.cc
+//	Routines for a kernel pipe, a bounded buffer in memory.
+//
+// 	Implemented in "monitor"-style, like SynchList -- each
+//	procedure holds the pipe lock, and uses condition wait and
+//	broadcast to block readers on an empty pipe and writers on a
+//	full one.
+
+#include "copyright.h"
+#include "synchpipe.h"
+
+//----------------------------------------------------------------------
+// SynchPipe::SynchPipe
+//	Allocate an empty pipe.  The creator holds one reference on each
+//	end.
+//----------------------------------------------------------------------
+
+SynchPipe::SynchPipe(char *debugName)
+{
+    name = debugName;
+    buffer = new char[PipeSize];
+    head = count = 0;
+    readers = writers = 1;
+    lock = new Lock("pipe lock");
+    notEmpty = new Condition("pipe not empty");
+    notFull = new Condition("pipe not full");
+}
+
+//----------------------------------------------------------------------
+// SynchPipe::~SynchPipe
+//	De-allocate the buffer and the synchronization objects.
+//----------------------------------------------------------------------
+
+SynchPipe::~SynchPipe()
+{
+    delete [] buffer;
+    delete lock;
+    delete notEmpty;
+    delete notFull;
+}
+
+//----------------------------------------------------------------------
+// SynchPipe::Read
+//	Copy up to "numBytes" bytes out of the pipe, waiting while it is
+//	empty and some writer may still fill it.  Returns the number of
+//	bytes read, 0 once the pipe is empty and has no writers.
+//----------------------------------------------------------------------
+
+int
+SynchPipe::Read(char *into, int numBytes)
+{
+    int done = 0;
+
+    lock->Acquire();
+    while (count == 0 && writers > 0)
+	notEmpty->Wait(lock);
+    while (done < numBytes && count > 0) {
+	int chunk = min(min(numBytes - done, count), PipeSize - head);
+	bcopy(buffer + head, into + done, chunk);
+	head = (head + chunk) % PipeSize;
+	count -= chunk;
+	done += chunk;
+    }
+    if (done > 0)
+	notFull->Broadcast(lock);
+    lock->Release();
+    DEBUG('f', "Read %d bytes from pipe %s\n", done, name);
+    return done;
+}
+
+//----------------------------------------------------------------------
+// SynchPipe::Write
+//	Copy "numBytes" bytes into the pipe, waiting for room when it is
+//	full.  Gives up early, returning the number of bytes written so
+//	far, if nobody is left to read them.
+//----------------------------------------------------------------------
+
+int
+SynchPipe::Write(char *from, int numBytes)
+{
+    int done = 0;
+
+    lock->Acquire();
+    while (done < numBytes && readers > 0) {
+	if (count == PipeSize) {
+	    notFull->Wait(lock);
+	    continue;
+	}
+	int tail = (head + count) % PipeSize;
+	int chunk = min(min(numBytes - done, PipeSize - count), PipeSize - tail);
+	bcopy(from + done, buffer + tail, chunk);
+	count += chunk;
+	done += chunk;
+	notEmpty->Broadcast(lock);
+    }
+    lock->Release();
+    DEBUG('f', "Wrote %d bytes to pipe %s\n", done, name);
+    return done;
+}
+
+//----------------------------------------------------------------------
+// SynchPipe::OpenEnd
+//	Record one more user of the read or write end, e.g. when a
+//	descriptor for it is shared with another thread.
+//----------------------------------------------------------------------
+
+void
+SynchPipe::OpenEnd(bool writing)
+{
+    lock->Acquire();
+    if (writing)
+	writers++;
+    else
+	readers++;
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// SynchPipe::CloseEnd
+//	Drop one user of the read or write end.  When the last writer
+//	goes, blocked readers wake up and see end of file; when the last
+//	reader goes, blocked writers wake up and give up.
+//
+//	Returns TRUE if neither end has users left; the caller then
+//	deletes the pipe.
+//----------------------------------------------------------------------
+
+bool
+SynchPipe::CloseEnd(bool writing)
+{
+    bool unused;
+
+    lock->Acquire();
+    if (writing) {
+	ASSERT(writers > 0);
+	if (--writers == 0)
+	    notEmpty->Broadcast(lock);
+    } else {
+	ASSERT(readers > 0);
+	if (--readers == 0)
+	    notFull->Broadcast(lock);
+    }
+    unused = (readers == 0 && writers == 0);
+    lock->Release();
+    return unused;
+}
@@ -0,0 +1,52 @@
+// synchpipe.h
+//	Data structures for a kernel pipe: a bounded byte buffer in
+//	memory, shared by the threads writing into one end and reading
+//	out of the other.
+//
+//	Replaces the old pipes that were built out of files on the
+//	simulated disk, so passing data through a pipe costs no disk I/O.
+
+#ifndef SYNCHPIPE_H
+#define SYNCHPIPE_H
+
+#include "copyright.h"
+#include "synch.h"
+
+#define PipeSize	1024	// bytes buffered before a writer waits
+
+// The following class defines a "synchronized pipe":
+//	1. Read waits until there is at least one byte to return, or
+//	until no writer is left (end of file).
+//	2. Write waits until all of its bytes fit, or until no reader
+//	is left.
+//	3. Each end counts its users, so the pipe can be handed to
+//	several threads and freed when the last one closes it.
+
+class SynchPipe {
+  public:
+    SynchPipe(char *debugName);		// an empty pipe, with one reader
+					// and one writer
+    ~SynchPipe();
+
+    int Read(char *into, int numBytes);	// read up to numBytes; returns
+					// the # read, 0 at end of file
+    int Write(char *from, int numBytes);// returns the # written; short
+					// only if the readers went away
+
+    void OpenEnd(bool writing);		// one more user of an end
+    bool CloseEnd(bool writing);	// one user fewer; returns TRUE
+					// when neither end is in use
+					// and the pipe can be deleted
+
+  private:
+    char *name;
+    char *buffer;			// circular buffer of PipeSize bytes
+    int head;				// index of the oldest byte
+    int count;				// # bytes in the buffer
+    int readers, writers;		// # users of each end
+    Lock *lock;				// one thread in the pipe at a time
+    Condition *notEmpty;		// wait in Read for data
+    Condition *notFull;			// wait in Write for room
+};
+
+#endif // SYNCHPIPE_H
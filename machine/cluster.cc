@@ -0,0 +1,366 @@
+// cluster.cc
+//	Routines to simulate several Nachos machines in one process.
+//	See cluster.h.
+//
+//	The host CPU is passed between machines by switching threads:
+//	the thread running on the machine giving up the CPU is parked,
+//	the globals are loaded from the machine taking over, and we
+//	switch to the thread that machine had parked (or to the first
+//	thread on its ready list, if it has never run).  The parked
+//	thread resumes, in the middle of Cluster::SwitchTo, when some
+//	later machine switches back to it.
+//
+//	Switches happen only with interrupts off, from Interrupt::OneTick
+//	(the machine got too far ahead) and from Interrupt::Idle (it has
+//	nothing to do for now).
+//
+//  DO NOT CHANGE -- part of the machine emulation
+
+#include "copyright.h"
+#include "system.h"
+#include "cluster.h"
+
+//----------------------------------------------------------------------
+// NodeIdle
+// 	The first thread on each new machine, like the main thread that
+//	Initialize makes for node 0.  It goes straight to sleep and is
+//	never woken, so the machine always has a thread to handle its
+//	interrupts in (inside Interrupt::Idle) while it has nothing else
+//	to run.
+//----------------------------------------------------------------------
+
+static void
+NodeIdle(int which)
+{
+    (void) interrupt->SetLevel(IntOff);
+    currentThread->Sleep();
+}
+
+//----------------------------------------------------------------------
+// StartThread
+// 	Fork "t" on the machine whose globals are loaded, from a thread
+//	running on another machine.  The new thread must not preempt the
+//	caller (Thread::Fork would put the caller on the wrong ready
+//	list), so it gets no better priority than the caller.
+//----------------------------------------------------------------------
+
+static void
+StartThread(Thread *t, VoidFunctionPtr func, int arg)
+{
+    if (t->getPriority() < currentThread->getPriority())
+	t->setPriority(currentThread->getPriority());
+    t->Fork(func, arg);
+}
+
+//----------------------------------------------------------------------
+// Node::Node
+// 	A machine whose globals are filled in by Cluster::Boot.
+//----------------------------------------------------------------------
+
+Node::Node()
+{
+    stats = NULL;
+    interrupt = NULL;
+    scheduler = NULL;
+    timer = NULL;
+    postOffice = NULL;
+    network = NULL;
+    parked = NULL;
+    idle = FALSE;
+}
+
+//----------------------------------------------------------------------
+// Node::Load
+// 	Make this machine's clock, interrupts, ready list and post office
+//	the ones the rest of Nachos uses.  The current thread is left
+//	alone; switching it is up to the scheduler.
+//----------------------------------------------------------------------
+
+void
+Node::Load()
+{
+    ::stats = stats;
+    ::interrupt = interrupt;
+    ::scheduler = scheduler;
+    ::timer = timer;
+    ::postOffice = postOffice;
+}
+
+//----------------------------------------------------------------------
+// Node::NextEvent
+// 	When, on this machine's clock, it next has something to do: now,
+//	if it has threads to run; when its next interrupt is due, if it
+//	is idle; NoEvent if it is idle with nothing pending.
+//
+//	"running" -- TRUE for the machine that has the host CPU, which
+//		is asking on its own behalf from Idle
+//----------------------------------------------------------------------
+
+int
+Node::NextEvent(bool running)
+{
+    if (!running && !idle)
+	return stats->totalTicks;
+    int when = interrupt->NextPending();
+    return (when < 0) ? NoEvent : when;
+}
+
+//----------------------------------------------------------------------
+// Cluster::Cluster
+// 	Set aside "numNodes" machines.  The globals set up by Initialize
+//	belong to node 0, which is running now.
+//----------------------------------------------------------------------
+
+Cluster::Cluster(int n)
+{
+    ASSERT(n > 0);
+    numNodes = n;
+    nodes = new Node[n];
+    active = 0;
+    horizon = NoEvent;
+}
+
+//----------------------------------------------------------------------
+// Cluster::~Cluster
+// 	Shut down each machine's post office, which reports on its links.
+//----------------------------------------------------------------------
+
+Cluster::~Cluster()
+{
+    for (int i = 0; i < numNodes; i++)
+	delete nodes[i].postOffice;
+    ::postOffice = NULL;
+    delete [] nodes;
+}
+
+//----------------------------------------------------------------------
+// Cluster::Boot
+// 	Give every machine but node 0 its own clock, interrupts, ready
+//	list and timer, and every machine a post office on the switch,
+//	with network address equal to its number.
+//
+//	A new machine's interrupts start out disabled, so nothing runs on
+//	it until it is first switched to.  It starts with one thread,
+//	which just waits for interrupts; see NodeIdle.
+//
+//	"reliability", "queueDepth", "linkConfig" -- as for PostOffice
+//	"timerHandler" -- handler for a time-slice timer on each machine,
+//		or NULL for none
+//----------------------------------------------------------------------
+
+void
+Cluster::Boot(double reliability, int queueDepth, char *linkConfig,
+	VoidFunctionPtr timerHandler)
+{
+    for (int i = 0; i < numNodes; i++) {
+	Node *node = &nodes[i];
+
+	if (i == 0) {
+	    node->stats = ::stats;
+	    node->interrupt = ::interrupt;
+	    node->scheduler = ::scheduler;
+	    node->timer = ::timer;
+	} else {
+	    node->stats = new Statistics();
+	    node->interrupt = new Interrupt;
+	    node->scheduler = new Scheduler();
+	    node->Load();
+	    if (timerHandler != NULL)
+		node->timer = new Timer(timerHandler, 0, TRUE);
+	    node->Load();
+	    StartThread(new Thread("machine idle"), NodeIdle, i);
+	}
+	node->postOffice = new PostOffice(i, reliability, 10, queueDepth,
+							linkConfig);
+    }
+    nodes[0].Load();
+    ComputeHorizon();
+}
+
+//----------------------------------------------------------------------
+// Cluster::Fork
+// 	Start "func" on every machine but node 0 (the caller's), in a
+//	thread of its own, passing it the machine's number.
+//----------------------------------------------------------------------
+
+void
+Cluster::Fork(VoidFunctionPtr func)
+{
+    for (int i = 1; i < numNodes; i++) {
+	nodes[i].Load();
+	StartThread(new Thread("node main"), func, i);
+    }
+    nodes[active].Load();
+}
+
+//----------------------------------------------------------------------
+// Cluster::Attach
+// 	Record the network device of machine "addr", so the switch can
+//	deliver packets to it.
+//----------------------------------------------------------------------
+
+void
+Cluster::Attach(int addr, Network *net)
+{
+    ASSERT(addr >= 0 && addr < numNodes);
+    nodes[addr].network = net;
+}
+
+//----------------------------------------------------------------------
+// Cluster::Carry
+// 	The switch: put a packet on its way to machine "to", where it is
+//	to arrive at time "when".  The sender may now only run until
+//	ClusterLookahead after that, since the receiver may answer.
+//----------------------------------------------------------------------
+
+void
+Cluster::Carry(int to, char *wire, int when)
+{
+    ASSERT(to >= 0 && to < numNodes && nodes[to].network != NULL);
+    nodes[to].network->Arrive(wire, when);
+    if (to != active)
+	horizon = min(horizon, when + ClusterLookahead);
+}
+
+//----------------------------------------------------------------------
+// Cluster::PastHorizon, Cluster::Yield
+// 	Called as time advances on the running machine.  Once it passes
+//	its horizon, some other machine is more than ClusterLookahead
+//	behind; switch to the one furthest behind.
+//----------------------------------------------------------------------
+
+bool
+Cluster::PastHorizon()
+{
+    return stats->totalTicks > horizon;
+}
+
+void
+Cluster::Yield()
+{
+    int when;
+    int next = Earliest(&when);
+
+    nodes[active].idle = FALSE;
+    if (next >= 0 && when < stats->totalTicks)
+	SwitchTo(next);
+    else
+	ComputeHorizon();
+}
+
+//----------------------------------------------------------------------
+// Cluster::RunOthers
+// 	Called when the running machine is idle.  If another machine has
+//	something to do before it does, switch to that machine, and
+//	return TRUE once we get the CPU back (with maybe a packet
+//	waiting).  Otherwise return FALSE; the caller can go ahead and
+//	move its clock on.
+//----------------------------------------------------------------------
+
+bool
+Cluster::RunOthers()
+{
+    int when;
+    int next = Earliest(&when);
+    int mine = nodes[active].NextEvent(TRUE);
+
+    if (next < 0 || when == NoEvent || when >= mine)
+	return FALSE;
+    nodes[active].idle = TRUE;
+    SwitchTo(next);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Cluster::Print
+// 	Print the performance statistics of every machine.
+//----------------------------------------------------------------------
+
+void
+Cluster::Print()
+{
+    for (int i = 0; i < numNodes; i++) {
+	printf("Machine %d:\n", i);
+	nodes[i].stats->Print();
+    }
+}
+
+//----------------------------------------------------------------------
+// Cluster::Earliest
+// 	Find the machine, other than the running one, that next has
+//	something to do.  Returns its number, and sets "when" to the
+//	time; returns -1 if there is no other machine.
+//----------------------------------------------------------------------
+
+int
+Cluster::Earliest(int *when)
+{
+    int best = -1;
+
+    *when = NoEvent;
+    for (int i = 0; i < numNodes; i++) {
+	if (i == active)
+	    continue;
+	int t = nodes[i].NextEvent(FALSE);
+	if (best < 0 || t < *when) {
+	    best = i;
+	    *when = t;
+	}
+    }
+    return best;
+}
+
+//----------------------------------------------------------------------
+// Cluster::ComputeHorizon
+// 	The running machine may go up to ClusterLookahead past the next
+//	event on any other machine.
+//----------------------------------------------------------------------
+
+void
+Cluster::ComputeHorizon()
+{
+    int when;
+
+    if (Earliest(&when) < 0 || when == NoEvent)
+	horizon = NoEvent;
+    else
+	horizon = when + ClusterLookahead;
+}
+
+//----------------------------------------------------------------------
+// Cluster::SwitchTo
+// 	Park the running thread, and hand the host CPU to machine "id".
+//	Returns when some machine switches back to us.
+//----------------------------------------------------------------------
+
+void
+Cluster::SwitchTo(int id)
+{
+    Thread *me = currentThread;
+    ThreadStatus myStatus = me->getStatus();
+    Thread *dying = threadToBeDestroyed;	// set if we are Finishing; we
+					// must not be deleted while parked
+    Node *to = &nodes[id];
+    Thread *next;
+
+    ASSERT(interrupt->getLevel() == IntOff);
+    DEBUG('n', "Switching from machine %d at %d to machine %d at %d\n",
+		active, stats->totalTicks, id, to->stats->totalTicks);
+
+    nodes[active].parked = me;
+    active = id;
+    to->Load();
+    next = to->parked;
+    to->parked = NULL;
+    if (next == NULL)			// first time this machine runs
+	next = scheduler->FindNextToRun();
+    ASSERT(next != NULL);
+    ComputeHorizon();
+
+    threadToBeDestroyed = NULL;
+    scheduler->Run(next);
+
+    // back on our own machine; whoever switched to us loaded its globals
+    me->setStatus(myStatus);
+    threadToBeDestroyed = dying;
+}
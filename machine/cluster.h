@@ -0,0 +1,111 @@
+// cluster.h
+//	Data structures to simulate several Nachos machines, connected
+//	by a network, inside one host process.
+//
+//	Each simulated machine (a Node) has its own clock and statistics,
+//	interrupt simulation, ready list and post office; these are the
+//	globals "stats", "interrupt", "scheduler", "timer" and
+//	"postOffice", which are switched to the Node whose threads are
+//	running.  Everything else (the file system, the user-program
+//	machine) is shared, so the cluster is meant for kernel-level
+//	network tests.
+//
+//	The networks are joined by an in-memory switch instead of UNIX
+//	sockets: a packet leaving one machine is scheduled as an
+//	interrupt on the receiving machine, at the simulated time it
+//	arrives there.
+//
+//	Time is kept consistent conservatively.  Every packet spends at
+//	least ClusterLookahead ticks on its link, so a machine can safely
+//	run ahead of the slowest other machine by that much: nothing can
+//	reach it from the past.  A machine that gets further ahead, or
+//	has nothing to do, hands the host CPU to the machine that is
+//	furthest behind.
+//
+//  DO NOT CHANGE -- part of the machine emulation
+
+#ifndef CLUSTER_H
+#define CLUSTER_H
+
+#include "copyright.h"
+#include "utility.h"
+
+#define ClusterLookahead NetworkTime	// least time on any link
+#define NoEvent		0x3fffffff	// "never", for a machine with
+					// nothing to do
+
+class Thread;
+class Statistics;
+class Interrupt;
+class Scheduler;
+class Timer;
+class PostOffice;
+class Network;
+
+// One simulated machine
+
+class Node {
+  public:
+    Node();
+
+    void Load();		// make this machine's the current globals
+    int NextEvent(bool running);// when this machine next has something
+				// to do; "running" if it is current
+
+    Statistics *stats;		// this machine's globals
+    Interrupt *interrupt;
+    Scheduler *scheduler;
+    Timer *timer;
+    PostOffice *postOffice;
+    Network *network;		// the network device, for the switch
+
+    Thread *parked;		// the thread that was running when the
+				// machine gave up the host CPU, or NULL
+				// if it has never run
+    bool idle;			// did it give up the CPU from Idle?
+};
+
+// The following class defines the whole set of machines and the switch
+// between them.
+
+class Cluster {
+  public:
+    Cluster(int numNodes);		// the machine running now becomes
+					// node 0
+    ~Cluster();				// shut down every post office
+
+    void Boot(double reliability, int queueDepth, char *linkConfig,
+	VoidFunctionPtr timerHandler);	// build the machines; called once
+					// the globals of node 0 exist
+    void Fork(VoidFunctionPtr func);	// run func(i) in a new thread on
+					// every machine i but node 0
+    int Size() { return numNodes; }
+
+    // called by the network device
+    void Attach(int addr, Network *net);// "net" is machine addr's device
+    void Carry(int to, char *wire, int when);
+					// deliver a packet to machine "to",
+					// arriving at time "when"
+
+    // called by the interrupt simulation
+    bool PastHorizon();			// has this machine run too far
+					// ahead of the others?
+    void Yield();			// let the others catch up
+    bool RunOthers();			// idle: if another machine has
+					// something to do sooner, run it
+					// and return TRUE
+    void Print();			// every machine's statistics
+
+  private:
+    Node *nodes;
+    int numNodes;
+    int active;				// the machine running now
+    int horizon;			// how far it may go
+
+    int Earliest(int *when);		// machine (other than the active
+					// one) with the earliest next event
+    void ComputeHorizon();
+    void SwitchTo(int id);		// give the host CPU to machine id
+};
+
+#endif // CLUSTER_H
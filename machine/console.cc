@@ -53,10 +53,16 @@ Console::Console(char *readFile, char *writeFile, VoidFunctionPtr readAvail,
     readHandler = readAvail;
     handlerArg = callArg;
     putBusy = FALSE;
-    incoming = EOF;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    putCount = 0;
+    inHead = inCount = 0;
+    pollPending = FALSE;
+    atEof = FALSE;
 
     // start polling for incoming packets
-    interrupt->Schedule(ConsoleReadPoll, (int)this, ConsoleTime, ConsoleReadInt);
+    polling = TRUE;
+    SchedulePoll();
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 }
 
 //----------------------------------------------------------------------
@@ -72,15 +78,53 @@ Console::~Console()
 	Close(writeFileNo);
 }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// Console::SchedulePoll
+// 	Arrange for CheckCharAvail to run ConsoleTime from now, unless a
+//	check is already on its way, or the input has ended.
+//----------------------------------------------------------------------
+
+void
+Console::SchedulePoll()
+{
+    if (pollPending || atEof)
+	return;
+    pollPending = TRUE;
+    interrupt->Schedule(ConsoleReadPoll, (int)this, ConsoleTime,
+			ConsoleReadInt);
+}
+
+//----------------------------------------------------------------------
+// Console::SetPolling
+// 	Start or stop checking the simulated keyboard.  While polling is
+//	off, typed characters simply wait in the UNIX file.
+//----------------------------------------------------------------------
+
+void
+Console::SetPolling(bool on)
+{
+    polling = on;
+    if (polling && inCount == 0)
+	SchedulePoll();
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 //----------------------------------------------------------------------
 // Console::CheckCharAvail()
 // 	Periodically called to check if a character is available for
 //	input from the simulated keyboard (eg, has it been typed?).
 //
 //	Only read it in if there is buffer space for it (if the previous
-//	character has been grabbed out of the buffer by the Nachos kernel).
-//	Invoke the "read" interrupt handler, once the character has been 
-//	put into the buffer. 
+//	characters have been grabbed out of the buffer by the Nachos
+//	kernel).  Everything already typed, up to the end of the line,
+//	comes in together, and the "read" interrupt handler is invoked
+//	once for the lot.
+//
+//	Polling continues only while it is turned on and the buffer is
+//	empty; GetChars restarts it once the buffer drains.  At the end
+//	of the input file, polling stops for good, and the handler is
+//	called anyway, so that a waiting reader finds out.
 //----------------------------------------------------------------------
 
 void
@@ -88,33 +132,44 @@ Console::CheckCharAvail()
 {
     char c;
 
-    // schedule the next time to poll for a packet
-    interrupt->Schedule(ConsoleReadPoll, (int)this, ConsoleTime, 
-			ConsoleReadInt);
-
-    // do nothing if character is already buffered, or none to be read
-    if ((incoming != EOF) || !PollFile(readFileNo))
-	return;	  
-
-    // otherwise, read character and tell user about it
-    Read(readFileNo, &c, sizeof(char));
-    incoming = c ;
-    stats->numConsoleCharsRead++;
-    (*readHandler)(handlerArg);	
+    pollPending = FALSE;
+    if (!polling || inCount > 0)
+	return;
+
+    // read whatever is there, up to the end of the line
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    while (inCount < ConsoleLineSize && RecordedPollFile(readFileNo)) {
+	if (RecordedReadPartial(readFileNo, &c, sizeof(char)) != sizeof(char)) {
+	    atEof = TRUE;		// end of file: PollFile will keep
+	    break;			// saying there's more, but there
+	}				// isn't
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+	incoming[inCount++] = c;
+	if (c == '\n')
+	    break;
+    }
+    if (inCount == 0 && !atEof) {
+	SchedulePoll();			// nothing yet, look again later
+	return;
+    }
+    inHead = 0;
+    stats->numConsoleCharsRead += inCount;
+    (*readHandler)(handlerArg);
 }
 
 //----------------------------------------------------------------------
 // Console::WriteDone()
 // 	Internal routine called when it is time to invoke the interrupt
-//	handler to tell the Nachos kernel that the output character has
-//	completed.
+//	handler to tell the Nachos kernel that the output characters
+//	have completed.
 //----------------------------------------------------------------------
 
 void
 Console::WriteDone()
 {
     putBusy = FALSE;
-    stats->numConsoleCharsWritten++;
+    stats->numConsoleCharsWritten += putCount;
+    putCount = 0;
     (*writeHandler)(handlerArg);
 }
 
@@ -127,12 +182,35 @@ Console::WriteDone()
 char
 Console::GetChar()
 {
-   char ch = incoming;
+   char ch;
 
-   incoming = EOF;
+   if (GetChars(&ch, 1) == 0)
+	return EOF;
    return ch;
 }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// Console::GetChars()
+// 	Copy up to "numChars" buffered input characters into "into".
+//	Returns the number copied.  Once the buffer is empty, go back
+//	to polling (if it is on) for the next line.
+//----------------------------------------------------------------------
+
+int
+Console::GetChars(char *into, int numChars)
+{
+    int n = min(numChars, inCount);
+
+    bcopy(incoming + inHead, into, n);
+    inHead += n;
+    inCount -= n;
+    if (inCount == 0 && polling)
+	SchedulePoll();
+    return n;
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 //----------------------------------------------------------------------
 // Console::PutChar()
 // 	Write a character to the simulated display, schedule an interrupt 
@@ -141,10 +219,28 @@ Console::GetChar()
 
 void
 Console::PutChar(char ch)
+{
+    PutChars(&ch, 1);
+}
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// Console::PutChars()
+// 	Write "numChars" characters to the simulated display in one go,
+//	and schedule a single interrupt for all of them.
+//----------------------------------------------------------------------
+
+void
+Console::PutChars(char *from, int numChars)
 {
     ASSERT(putBusy == FALSE);
-    WriteFile(writeFileNo, &ch, sizeof(char));
+    ASSERT(numChars > 0 && numChars <= ConsoleLineSize);
+    if (writeFileNo == 1)
+	fflush(stdout);			// keep order with kernel printf's
+    WriteFile(writeFileNo, from, numChars);
     putBusy = TRUE;
+    putCount = numChars;
     interrupt->Schedule(ConsoleWriteDone, (int)this, ConsoleTime,
 					ConsoleWriteInt);
 }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
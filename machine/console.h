@@ -26,6 +26,8 @@
 #include "copyright.h"
 #include "utility.h"
 
+#define ConsoleLineSize	128	// most chars moved by one interrupt
+
 // The following class defines a hardware console device.
 // Input and output to the device is simulated by reading 
 // and writing to UNIX files ("readFile" and "writeFile").
@@ -52,6 +54,21 @@ class Console {
     				// "readHandler" is called whenever there is 
 				// a char to be gotten
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    void PutChars(char *from, int numChars);
+				// Like PutChar, but for up to ConsoleLineSize
+				// chars at once -- one interrupt for all
+    int GetChars(char *into, int numChars);
+				// Take up to numChars of the buffered input;
+				// returns how many (0 if none)
+    void SetPolling(bool on);	// Whether to keep checking the keyboard.
+				// Turn it off when nobody is reading, so
+				// an idle console costs no interrupts.
+    bool AtEof() { return atEof && inCount == 0; }
+				// Has the input ended, and all of it
+				// been taken?
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 // internal emulation routines -- DO NOT call these. 
     void WriteDone();	 	// internal routines to signal I/O completion
     void CheckCharAvail();
@@ -67,9 +84,16 @@ class Console {
 					// interrupt handlers
     bool putBusy;    			// Is a PutChar operation in progress?
 					// If so, you can't do another one!
-    char incoming;    			// Contains the character to be read,
-					// if there is one available. 
-					// Otherwise contains EOF.
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    int putCount;			// # chars in the write in progress
+    char incoming[ConsoleLineSize];	// Input that arrived but hasn't
+					// been taken yet: up to one line
+    int inHead, inCount;		// next char to hand out, # left
+    bool polling;			// keep checking the keyboard?
+    bool pollPending;			// is a CheckCharAvail scheduled?
+    bool atEof;				// has the keyboard file ended?
+    void SchedulePoll();
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 };
 
 #endif // CONSOLE_H
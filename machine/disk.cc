@@ -28,6 +28,10 @@
 // dummy procedure because we can't take a pointer of a member function
 static void DiskDone(int arg) { ((Disk *)arg)->HandleInterrupt(); }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+DiskStats *diskStats = NULL;		// made by Initialize, if -diskstats
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 //----------------------------------------------------------------------
 // Disk::Disk()
 // 	Initialize a simulated disk.  Open the UNIX file (creating it
@@ -50,6 +54,10 @@ Disk::Disk(char* name, VoidFunctionPtr callWhenDone, int callArg)
     handlerArg = callArg;
     lastSector = 0;
     bufferInit = 0;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    seekTicks = rotationTicks = 0;
+    fromBuffer = FALSE;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     fileno = OpenForReadWrite(name, FALSE);
     if (fileno >= 0) {		 	// file exists, check magic number
@@ -127,8 +135,14 @@ Disk::ReadRequest(int sectorNumber, char* data)
 	     PrintSector(FALSE, sectorNumber, data);
 
     active = TRUE;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    RecordRequest(sectorNumber);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     UpdateLast(sectorNumber);
     stats->numDiskReads++;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    TRACE(TraceDiskRequest, sectorNumber, 0);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     interrupt->Schedule(DiskDone, (int) this, ticks, DiskInt);
 }
 
@@ -147,8 +161,14 @@ Disk::WriteRequest(int sectorNumber, char* data)
 	PrintSector(TRUE, sectorNumber, data);
 
     active = TRUE;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    RecordRequest(sectorNumber);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     UpdateLast(sectorNumber);
     stats->numDiskWrites++;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    TRACE(TraceDiskRequest, sectorNumber, 1);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     interrupt->Schedule(DiskDone, (int) this, ticks, DiskInt);
 }
 
@@ -162,6 +182,9 @@ void
 Disk::HandleInterrupt ()
 {
     active = FALSE;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    TRACE(TraceDiskDone, lastSector, 0);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     (*handler)(handlerArg);
 }
 
@@ -242,11 +265,20 @@ Disk::ComputeLatency(int newSector, bool writing)
 		&& (((timeAfter - bufferInit) / RotationTime)
 	     		> ModuloDiff(newSector, bufferInit / RotationTime))) {
         DEBUG('d', "Request latency = %d\n", RotationTime);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+	seekTicks = rotationTicks = 0;
+	fromBuffer = TRUE;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 	return RotationTime; // time to transfer sector from the track buffer
     }
 #endif
 
     rotation += ModuloDiff(newSector, timeAfter / RotationTime) * RotationTime;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    seekTicks = seek;
+    rotationTicks = rotation;
+    fromBuffer = FALSE;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     DEBUG('d', "Request latency = %d\n", seek + rotation + RotationTime);
     return(seek + rotation + RotationTime);
@@ -269,3 +301,157 @@ Disk::UpdateLast(int newSector)
     lastSector = newSector;
     DEBUG('d', "Updating last sector = %d, %d\n", lastSector, bufferInit);
 }
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// Disk::RecordRequest
+// 	Tell diskStats (if -diskstats) about a request for "sectorNumber",
+//	whose latency ComputeLatency has just worked out.  Must be called
+//	before UpdateLast, while lastSector is still the previous request.
+//----------------------------------------------------------------------
+
+void
+Disk::RecordRequest(int sectorNumber)
+{
+    if (diskStats != NULL)
+	diskStats->Record(sectorNumber, lastSector, seekTicks, rotationTicks,
+		RotationTime, fromBuffer);
+}
+
+//----------------------------------------------------------------------
+// DiskStats::DiskStats
+// 	Initialize the disk statistics to zero.
+//----------------------------------------------------------------------
+
+DiskStats::DiskStats()
+{
+    int i, j;
+
+    requests = bufferHits = 0;
+    for (i = 0; i < NumDiskParts; i++) {
+	ticks[i] = 0;
+	for (j = 0; j < NumLatencyBuckets; j++)
+	    histogram[i][j] = 0;
+    }
+    for (i = 0; i < NumDiskPatterns; i++)
+	patterns[i] = 0;
+    for (i = 0; i <= NumSectors; i++)
+	fileRequests[i] = fileTicks[i] = 0;
+}
+
+// which histogram bucket "time" goes in
+static int
+LatencyBucket(int time)
+{
+    int bucket = 0;
+
+    while (time > 0 && bucket < NumLatencyBuckets - 1) {
+	time >>= 1;
+	bucket++;
+    }
+    return bucket;
+}
+
+//----------------------------------------------------------------------
+// DiskStats::Record
+// 	Count one disk request.
+//
+//	"sector" -- the sector requested
+//	"lastSector" -- the sector of the request before it
+//	"seek", "rotation", "transfer" -- the parts of its latency, in ticks
+//	"buffered" -- whether the track buffer satisfied it
+//----------------------------------------------------------------------
+
+void
+DiskStats::Record(int sector, int lastSector, int seek, int rotation,
+	int transfer, bool buffered)
+{
+    int part[NumDiskParts];
+    int i, file;
+
+    part[DiskSeek] = seek;
+    part[DiskRotation] = rotation;
+    part[DiskTransfer] = transfer;
+    part[DiskTotal] = seek + rotation + transfer;
+
+    requests++;
+    for (i = 0; i < NumDiskParts; i++) {
+	histogram[i][LatencyBucket(part[i])]++;
+	ticks[i] += part[i];
+    }
+
+    if (sector == lastSector + 1)
+	patterns[DiskSequential]++;
+    else if (sector / SectorsPerTrack == lastSector / SectorsPerTrack)
+	patterns[DiskSameTrack]++;
+    else
+	patterns[DiskOtherTrack]++;
+    if (buffered)
+	bufferHits++;
+
+    file = currentThread->ioFile;
+    if (file < 0 || file >= NumSectors)
+	file = NumSectors;			// not for an open file
+    fileRequests[file]++;
+    fileTicks[file] += part[DiskTotal];
+}
+
+//----------------------------------------------------------------------
+// DiskStats::Print
+// 	Print the disk statistics: the access pattern, the latency
+//	histograms side by side (only the buckets that were used), and
+//	the requests for each file.
+//----------------------------------------------------------------------
+
+static char *diskPartNames[] = { "seek", "rotation", "transfer", "total" };
+
+void
+DiskStats::Print()
+{
+    int i, j, low;
+    bool used;
+
+    printf("Disk requests: %d; sequential %d, same track %d, other track %d; "
+	"from the track buffer %d\n", requests, patterns[DiskSequential],
+	patterns[DiskSameTrack], patterns[DiskOtherTrack], bufferHits);
+    if (requests == 0)
+	return;
+
+    printf("Disk latency (ticks)      ");
+    for (j = 0; j < NumDiskParts; j++)
+	printf(" %9s", diskPartNames[j]);
+    printf("\n");
+    for (i = 0; i < NumLatencyBuckets; i++) {
+	used = FALSE;
+	for (j = 0; j < NumDiskParts; j++)
+	    if (histogram[j][i] > 0)
+		used = TRUE;
+	if (!used)
+	    continue;
+	low = (i == 0) ? 0 : (1 << (i - 1));
+	if (i == 0)
+	    printf("  %-24s", "0");
+	else if (i == NumLatencyBuckets - 1)
+	    printf("  %8d and up         ", low);
+	else
+	    printf("  %8d .. %-12d", low, (1 << i) - 1);
+	for (j = 0; j < NumDiskParts; j++)
+	    printf(" %9d", histogram[j][i]);
+	printf("\n");
+    }
+    printf("  %-24s", "mean");
+    for (j = 0; j < NumDiskParts; j++)
+	printf(" %9d", ticks[j] / requests);
+    printf("\n");
+
+    printf("Disk requests by file (header sector):\n");
+    for (i = 0; i <= NumSectors; i++)
+	if (fileRequests[i] > 0) {
+	    if (i == NumSectors)
+		printf("  %-8s", "no file");
+	    else
+		printf("  %-8d", i);
+	    printf(" requests %d, ticks %d\n", fileRequests[i], fileTicks[i]);
+	}
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
@@ -52,6 +52,56 @@
 #define NumSectors 		(SectorsPerTrack * NumTracks)
 					// total # of sectors per disk
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+// With -diskstats, the disk keeps statistics on the requests it serves,
+// to judge changes to how files are laid out and requests scheduled:
+//
+//	histograms of request latency, in powers of two, split into the
+//	  seek, the rotational delay, and the transfer;
+//	how the requests were spread over the disk: sequential (the
+//	  sector after the last one), elsewhere on the same track, or
+//	  on another track;
+//	how many reads the track buffer satisfied;
+//	which open file each request was for.
+//
+// A request is charged to the file whose header is at sector
+// currentThread->ioFile, which OpenFile sets while it reads or writes
+// (so the free map is sector 0, the root directory sector 1).  Other
+// requests -- fetching the header to open a file, say -- aren't
+// charged to any file.
+
+#define NumLatencyBuckets	20	// bucket 0 counts times of 0 ticks,
+					// bucket i > 0, [2^(i-1), 2^i)
+
+enum DiskPart { DiskSeek, DiskRotation, DiskTransfer, DiskTotal,
+		NumDiskParts };
+enum DiskPattern { DiskSequential, DiskSameTrack, DiskOtherTrack,
+		NumDiskPatterns };
+
+class DiskStats {
+  public:
+    DiskStats();			// everything zero
+
+    void Record(int sector, int lastSector, int seek, int rotation,
+		int transfer, bool buffered);
+					// note a request for "sector", after
+					// one for "lastSector", and the parts
+					// of its latency
+    void Print();			// at halt
+
+  private:
+    int requests;
+    int histogram[NumDiskParts][NumLatencyBuckets];
+    int ticks[NumDiskParts];		// total of each part
+    int patterns[NumDiskPatterns];
+    int bufferHits;			// reads from the track buffer
+    int fileRequests[NumSectors + 1];	// by header sector; the last
+    int fileTicks[NumSectors + 1];	// entry is for no file
+};
+
+extern DiskStats *diskStats;		// -diskstats, else NULL
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 class Disk {
   public:
     Disk(char* name, VoidFunctionPtr callWhenDone, int callArg);
@@ -88,6 +138,12 @@ class Disk {
     int TimeToSeek(int newSector, int *rotate); // time to get to the new track
     int ModuloDiff(int to, int from);        // # sectors between to and from
     void UpdateLast(int newSector);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    int seekTicks;			// the parts of the latency last
+    int rotationTicks;			// computed by ComputeLatency, for
+    bool fromBuffer;			// diskStats
+    void RecordRequest(int sectorNumber);	// tell diskStats
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 };
 
 #endif // DISK_H
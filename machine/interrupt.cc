@@ -29,7 +29,8 @@
 
 static char *intLevelNames[] = { "off", "on"};
 static char *intTypeNames[] = { "timer", "disk", "console write",
-			"console read", "network send", "network recv"};
+			"console read", "network send", "network recv",
+			"retransmit timer"};
 
 //----------------------------------------------------------------------
 // PendingInterrupt::PendingInterrupt
@@ -65,6 +66,11 @@ Interrupt::Interrupt()
     inHandler = FALSE;
     yieldOnReturn = FALSE;
     status = SystemMode;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    inputFd = -1;
+    inputHandler = NULL;
+    watchingInput = FALSE;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 }
 
 //----------------------------------------------------------------------
@@ -157,10 +163,20 @@ Interrupt::OneTick()
     if (status == SystemMode) {
         stats->totalTicks += SystemTick;
         stats->systemTicks += SystemTick;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+	currentThread->usage.systemTicks += SystemTick;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     } else {					// USER_PROGRAM
         stats->totalTicks += UserTick;
         stats->userTicks += UserTick;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+	currentThread->usage.userTicks += UserTick;
+#ifdef USER_PROGRAM
+	if (profileInterval > 0)
+	    ProfileTick(UserTick);		// -prof: maybe take a sample
+#endif
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     }
 
     DEBUG('i', "\n== Tick %d ==\n", stats->totalTicks);
@@ -189,8 +205,20 @@ Interrupt::OneTick()
     ChangeLevel(IntOn, IntOff);		// first, turn off interrupts
 					// (interrupt handlers run with
 					// interrupts disabled)
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (watchingInput && stats->totalTicks >= nextInputCheck) {
+	nextInputCheck = stats->totalTicks + inputInterval;
+	CheckInput(0);			// just a look, no waiting
+    }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     while (CheckIfDue(FALSE))		// check for pending interrupts
 	;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#ifdef NETWORK
+    if (cluster != NULL && cluster->PastHorizon())
+	cluster->Yield();		// let the machines behind us catch up
+#endif
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     ChangeLevel(IntOff, IntOn);		// re-enable interrupts
     if (yieldOnReturn) {		// if the timer device handler asked
 					// for a context switch, ok to do it now
@@ -228,14 +256,33 @@ Interrupt::YieldOnReturn()
 //	on the ready queue, the only thing to do is to advance
 //	simulated time until the next scheduled hardware interrupt.
 //
-//	If there are no pending interrupts, stop.  There's nothing
-//	more for us to do.
+//	If an input source (the network) is being watched, input from
+//	outside can also make a thread runnable.  So before moving the
+//	clock, sleep in the host on the input source, for as long as
+//	the next pending interrupt is away; and if there is no pending
+//	interrupt at all, for as long as it takes.  An idle machine
+//	waiting for packets thus uses no host CPU.
+//
+//	If there are no pending interrupts and no input to wait for,
+//	stop.  There's nothing more for us to do.
 //----------------------------------------------------------------------
 void
 Interrupt::Idle()
 {
     DEBUG('i', "Machine idling; checking for interrupts.\n");
     status = IdleMode;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (watchingInput && CheckInput(IdleWaitTime())) {
+	IdleReturn();
+	return;
+    }
+#ifdef NETWORK
+    if (cluster != NULL && cluster->RunOthers()) {
+	IdleReturn();			// another machine was further
+	return;				// behind; it has run until it
+    }					// handed the host CPU back
+#endif
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     if (CheckIfDue(TRUE)) {		// check for any pending interrupts
     	while (CheckIfDue(FALSE))	// check for any other pending
 	    ;				// interrupts
@@ -245,11 +292,20 @@ Interrupt::Idle()
 	return;				// return in case there's now
 					// a runnable thread
     }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    // only the time-slice daemon is left; input from outside is now
+    // the one thing that can wake us up
+    if (watchingInput && CheckInput(-1)) {
+	IdleReturn();
+	return;
+    }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     // if there are no pending interrupts, and nothing is on the ready
-    // queue, it is time to stop.   If the console or the network is
-    // operating, there are *always* pending interrupts, so this code
-    // is not reached.  Instead, the halt must be invoked by the user program.
+    // queue, it is time to stop.   If the console is operating, there
+    // are *always* pending interrupts, and if the network is, we wait
+    // above for its packets, so this code is not reached.  Instead,
+    // the halt must be invoked by the user program.
 
     DEBUG('i', "Machine idle.  No interrupts to do.\n");
     printf("No threads ready or runnable, and no pending interrupts.\n");
@@ -257,6 +313,22 @@ Interrupt::Idle()
     Halt();
 }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// Interrupt::IdleReturn
+// 	Leave Idle after something happened that may have put a thread
+//	on the ready queue.  Since the ready queue was empty, the yield
+//	is automatic.
+//----------------------------------------------------------------------
+
+void
+Interrupt::IdleReturn()
+{
+    yieldOnReturn = FALSE;
+    status = SystemMode;
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 //----------------------------------------------------------------------
 // Interrupt::Halt
 // 	Shut down Nachos cleanly, printing out performance statistics.
@@ -265,7 +337,30 @@ void
 Interrupt::Halt()
 {
     printf("Machine halting!\n\n");
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#ifdef NETWORK
+    if (cluster != NULL)
+	cluster->Print();		// every machine's statistics
+    else
+#endif
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     stats->Print();
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (showUsage)
+	PrintUsage();			// -stats: who used what
+    if (synchProfiling)
+	PrintSynchStats();		// -lockstat: who waited for what
+#ifdef USER_PROGRAM
+    if (profileInterval > 0)
+	PrintProgramProfiles();		// -prof: where programs spent time
+    if (minMips >= 0 && !machine->PrintSpeed())
+	exitStatus = 1;			// -mips: the simulator got too slow
+#endif
+#ifdef FILESYS
+    if (diskStats != NULL)
+	diskStats->Print();		// -diskstats: how the disk was used
+#endif
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     Cleanup();     // Never returns.
 }
 
@@ -344,6 +439,9 @@ Interrupt::CheckIfDue(bool advanceClock)
 
     DEBUG('i', "Invoking interrupt handler for the %s at time %d\n",
 			intTypeNames[toOccur->type], toOccur->when);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    TRACE(TraceInterrupt, toOccur->type, stats->totalTicks - when);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 #ifdef USER_PROGRAM
     if (machine != NULL)
     	machine->DelayedLoad(0, 0);
@@ -359,6 +457,139 @@ Interrupt::CheckIfDue(bool advanceClock)
     return TRUE;
 }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// Interrupt::SetInputSource
+// 	Called by a device simulator (the network) whose input arrives
+//	from outside Nachos, on a host file, instead of being scheduled
+//	ahead of time.  Rather than the device polling itself with a
+//	stream of interrupts, we look at the file every "interval" ticks
+//	while the machine is busy, and block on it while the machine is
+//	idle.
+//
+//	"fd" is the host file (or socket) to watch
+//	"handler" is called, as an interrupt handler, when it has input
+//	"arg" is the argument to pass to the handler
+//	"interval" is how often (in simulated time) to look while busy
+//----------------------------------------------------------------------
+
+void
+Interrupt::SetInputSource(int fd, VoidFunctionPtr handler, int arg,
+	int interval)
+{
+    inputFd = fd;
+    inputHandler = handler;
+    inputArg = arg;
+    inputInterval = interval;
+    nextInputCheck = stats->totalTicks + interval;
+    watchingInput = TRUE;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::WatchInput
+// 	Stop (or resume) checking the input source.  The device turns
+//	the checks off while it holds input nobody has taken yet, so
+//	that an idle machine doesn't spin on a file that stays readable.
+//----------------------------------------------------------------------
+
+void
+Interrupt::WatchInput(bool on)
+{
+    watchingInput = (on && inputHandler != NULL);
+}
+
+//----------------------------------------------------------------------
+// Interrupt::IdleWaitTime
+// 	How long, in host microseconds, the idle machine may wait for
+//	input before the next pending interrupt is due.  -1 means nothing
+//	is due (see NextPending), so we can wait for as long as it takes.
+//	Never more than a second, however far off the interrupt is.
+//----------------------------------------------------------------------
+
+int
+Interrupt::IdleWaitTime()
+{
+    int when = NextPending();
+
+    if (when < 0)
+	return -1;
+    if (when <= stats->totalTicks)
+	return 0;
+    return min(when - stats->totalTicks, 1000000 / IdleUsecPerTick)
+							* IdleUsecPerTick;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::NextPending
+// 	Return when the next pending interrupt is due, or -1 if there is
+//	nothing to wait for: no pending interrupt, or just the time-slice
+//	daemon (see CheckIfDue).
+//----------------------------------------------------------------------
+
+int
+Interrupt::NextPending()
+{
+    int when;
+    PendingInterrupt *next = (PendingInterrupt *)pending->SortedRemove(&when);
+
+    if (next == NULL)
+	return -1;
+    bool onlyTimer = (next->type == TimerInt) && pending->IsEmpty();
+    pending->SortedInsert(next, when);
+    return onlyTimer ? -1 : when;
+}
+
+//----------------------------------------------------------------------
+// Interrupt::ScheduleAt
+// 	Like Schedule, but for absolute simulated time "when".  Used to
+//	hand a packet from one simulated machine to another, whose clock
+//	is not the one in "stats" right now.
+//----------------------------------------------------------------------
+
+void
+Interrupt::ScheduleAt(VoidFunctionPtr handler, int arg, int when, IntType type)
+{
+    PendingInterrupt *toOccur = new PendingInterrupt(handler, arg, when, type);
+
+    DEBUG('i', "Scheduling interrupt handler the %s at time = %d\n",
+					intTypeNames[type], when);
+    pending->SortedInsert(toOccur, when);
+}
+
+//----------------------------------------------------------------------
+// Interrupt::CheckInput
+// 	Wait up to "usec" host microseconds (forever if negative) for
+//	the input source to have something, and if it does, invoke its
+//	handler just as CheckIfDue invokes a pending interrupt.
+//
+//	Returns TRUE if the handler was called.
+//----------------------------------------------------------------------
+
+bool
+Interrupt::CheckInput(int usec)
+{
+    MachineStatus old = status;
+
+    ASSERT(level == IntOff);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (!RecordedWaitForFile(inputFd, usec))
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+	return FALSE;
+
+    DEBUG('i', "Invoking input handler at time %d\n", stats->totalTicks);
+#ifdef USER_PROGRAM
+    if (machine != NULL)
+    	machine->DelayedLoad(0, 0);
+#endif
+    inHandler = TRUE;
+    status = SystemMode;
+    (*inputHandler)(inputArg);
+    status = old;
+    inHandler = FALSE;
+    return TRUE;
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 //----------------------------------------------------------------------
 // PrintPending
 // 	Print information about an interrupt that is scheduled to occur.
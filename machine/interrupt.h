@@ -38,6 +38,13 @@
 #include "copyright.h"
 #include "list.h"
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#define IdleUsecPerTick	200	// host time an idle machine lets pass for
+				// each tick of simulated time, while it
+				// waits for input from outside (the old
+				// network poll slept 20ms per NetworkTime)
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 // Interrupts can be disabled (IntOff) or enabled (IntOn)
 enum IntStatus { IntOff, IntOn };
 
@@ -50,7 +57,7 @@ enum MachineStatus {IdleMode, SystemMode, UserMode};
 // In Nachos, we support a hardware timer device, a disk, a console
 // display and keyboard, and a network.
 enum IntType { TimerInt, DiskInt, ConsoleWriteInt, ConsoleReadInt, 
-				NetworkSendInt, NetworkRecvInt};
+				NetworkSendInt, NetworkRecvInt, RetransmitInt};
 
 // The following class defines an interrupt that is scheduled
 // to occur in the future.  The internal data structures are
@@ -112,6 +119,22 @@ class Interrupt {
     
     void OneTick();       		// Advance simulated time
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    void SetInputSource(int fd, VoidFunctionPtr handler, int arg,
+	int interval);			// "handler" is to be called when
+					// host file "fd" has input.  Checked
+					// every "interval" ticks while busy;
+					// waited on when idle.
+    void WatchInput(bool on);		// Turn the input checks off while
+					// the device can't take more input
+    void ScheduleAt(VoidFunctionPtr handler, int arg, int when,
+	IntType type);			// Like Schedule, but at absolute
+					// time "when", which may be on
+					// another machine's clock
+    int NextPending();			// When the next interrupt is due;
+					// -1 if only the timer is left
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
   private:
     IntStatus level;		// are interrupts enabled or disabled?
     List *pending;		// the list of interrupts scheduled
@@ -121,6 +144,20 @@ class Interrupt {
 				// on return from the interrupt handler
     MachineStatus status;	// idle, kernel mode, user mode
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    int inputFd;		// host file to watch, -1 if none
+    VoidFunctionPtr inputHandler; // called when inputFd has something
+    int inputArg;
+    int inputInterval;		// ticks between checks while busy
+    int nextInputCheck;		// when to check next
+    bool watchingInput;		// FALSE while the device is full
+
+    int IdleWaitTime();		// how long Idle may wait for input
+    void IdleReturn();		// leave Idle, something may be runnable
+    bool CheckInput(int usec);	// wait up to usec for input, and call
+				// inputHandler if there is some
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
     // these functions are internal to the interrupt simulation code
 
     bool CheckIfDue(bool advanceClock); // Check if an interrupt is supposed
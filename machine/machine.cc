@@ -11,6 +11,14 @@
 #include "machine.h"
 #include "system.h"
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+// Size of user memory; see machine.h
+int PageSize = SectorSize;
+int NumPhysPages = 32;
+int TLBSize = 4;
+double minMips = -1;			// -mips not given
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 // Textual names of the exceptions that can be generated by user program
 // execution, for debugging.
 static char* exceptionNames[] = { "no exception", "syscall",
@@ -73,6 +81,24 @@ Machine::Machine(bool debug)
 
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 		memoryManagement = new BitMap(NumPhysPages);
+		frameRefs = new int[NumPhysPages];
+		for (i = 0; i < NumPhysPages; i++)
+				frameRefs[i] = 0;
+		textNext = new int[NumPhysPages];
+		textFile = new int[NumPhysPages];
+		textAddr = new int[NumPhysPages];
+		for (i = 0; i < NumPhysPages; i++)
+				textFile[i] = -1;
+		for (i = 0; i < TextHashSize; i++)
+				textBucket[i] = -1;
+		FlushTranslateMemo();
+
+		numInstructions = 0;
+		hostStart = 0;
+		phase = SimKernel;
+		sampling = FALSE;
+		for (i = 0; i < NumSimPhases; i++)
+				phaseSamples[i] = 0;
 
 // //comment this out unless in challenge 2
 // 	invertedPageTable = new TranslationEntry[NumPhysPages];
@@ -104,6 +130,11 @@ Machine::~Machine()
         delete [] tlb;
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 		delete memoryManagement;
+		delete [] frameRefs;
+		delete [] textNext;
+		delete [] textFile;
+		delete [] textAddr;
+		CallOnHostTick(NULL, 0);	// stop sampling, if we were
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 }
 
@@ -126,7 +157,15 @@ Machine::RaiseException(ExceptionType which, int badVAddr)
     registers[BadVAddrReg] = badVAddr;
     DelayedLoad(0, 0);			// finish anything in progress
     interrupt->setStatus(SystemMode);
-    ExceptionHandler(which);		// interrupts are enabled at this point
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (TrackPhase) {
+	int oldPhase = phase;		// the kernel's time isn't the
+	phase = SimKernel;		// simulator's
+	ExceptionHandler(which);	// interrupts are enabled at this point
+	phase = oldPhase;
+    } else
+	ExceptionHandler(which);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     interrupt->setStatus(UserMode);
 }
 
@@ -240,3 +279,161 @@ void Machine::PCAdvance() {
 	 WriteRegister(NextPCReg, registers[NextPCReg] + sizeof(int));
 }
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// Machine::FlushTranslateMemo
+// 	Drop the remembered instruction and data translations, so the
+//	next access walks the page table again.  Translate doesn't look at
+//	the page table on a memo hit, so this must be called whenever the
+//	current page table, or any entry in it, changes.
+//----------------------------------------------------------------------
+
+void Machine::FlushTranslateMemo() {
+	 fetchMemo.size = 0;
+	 readMemo.size = 0;
+	 writeMemo.size = 0;
+}
+
+//----------------------------------------------------------------------
+// Machine::ShareFrame
+// 	Record one more page table mapping an already allocated frame,
+//	e.g. a read-only text page shared between two address spaces.
+//----------------------------------------------------------------------
+
+void Machine::ShareFrame(int frame) {
+	 ASSERT(memoryManagement->Test(frame) && frameRefs[frame] > 0);
+	 frameRefs[frame] ++;
+}
+
+//----------------------------------------------------------------------
+// Machine::ReleaseFrame
+// 	Drop one mapping of "frame".  The frame goes back to
+//	memoryManagement only when nobody maps it any more, and then it
+//	no longer holds any text page.  Frames that were never counted
+//	(refs 0) are treated as singly mapped.
+//
+//	Returns TRUE if the frame was actually freed.
+//----------------------------------------------------------------------
+
+bool Machine::ReleaseFrame(int frame) {
+	 if (frameRefs[frame] > 1) {
+			 frameRefs[frame] --;
+			 return FALSE;
+	 }
+	 frameRefs[frame] = 0;
+	 if (textFile[frame] != -1) {
+			 int *p = &textBucket[TextHash(textFile[frame], textAddr[frame])];
+			 while (*p != frame)
+					 p = &textNext[*p];
+			 *p = textNext[frame];
+			 textFile[frame] = -1;
+	 }
+	 if (!memoryManagement->Test(frame))
+			 return FALSE;
+	 memoryManagement->Clear(frame);
+	 return TRUE;
+}
+
+//----------------------------------------------------------------------
+// Machine::FindTextFrame, Machine::SetTextFrame
+// 	Look up, or record, which frame holds the text page at offset
+//	"fileAddr" of the executable whose header is at sector "file", so
+//	that address spaces running the same program can share it.  The
+//	frames are kept in a hash table on (file, fileAddr).
+//----------------------------------------------------------------------
+
+int Machine::TextHash(int file, int fileAddr) {
+	 return ((unsigned) file * 31 + (unsigned) fileAddr / PageSize)
+						 % TextHashSize;
+}
+
+int Machine::FindTextFrame(int file, int fileAddr) {
+	 int frame;
+
+	 for (frame = textBucket[TextHash(file, fileAddr)]; frame != -1;
+						 frame = textNext[frame])
+			 if (textFile[frame] == file && textAddr[frame] == fileAddr)
+					 return frame;
+	 return -1;
+}
+
+void Machine::SetTextFrame(int frame, int file, int fileAddr) {
+	 int hash = TextHash(file, fileAddr);
+
+	 ASSERT(textFile[frame] == -1 && frameRefs[frame] > 0);
+	 textFile[frame] = file;
+	 textAddr[frame] = fileAddr;
+	 textNext[frame] = textBucket[hash];
+	 textBucket[hash] = frame;
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// SampleSimulator
+// 	Called from a host signal every HostSampleUsec of host CPU time:
+//	note what the simulator was doing.
+//----------------------------------------------------------------------
+
+static void
+SampleSimulator()
+{
+    machine->phaseSamples[machine->phase]++;
+}
+
+//----------------------------------------------------------------------
+// Machine::StartSampling
+// 	Start sampling where the simulator spends its host CPU time, for
+//	-mips.  The samples stop when the Machine is deleted.  Without
+//	phase tracking (-DNO_DEBUG) there is nothing to sample.
+//----------------------------------------------------------------------
+
+void
+Machine::StartSampling()
+{
+#ifndef NO_DEBUG
+    sampling = TRUE;
+    CallOnHostTick(SampleSimulator, HostSampleUsec);
+#endif
+}
+
+//----------------------------------------------------------------------
+// Machine::PrintSpeed
+// 	Print how fast the simulator ran: user instructions per second of
+//	host time, from the first Run to now, and how its host CPU time
+//	was shared between translating addresses, decoding and executing
+//	instructions, and processing interrupts (including the context
+//	switches they cause).
+//
+//	Returns FALSE if it ran at fewer than minMips million instructions
+//	per second.
+//----------------------------------------------------------------------
+
+static char *phaseNames[] = { "kernel", "translate", "decode", "execute",
+				"interrupts" };
+
+bool
+Machine::PrintSpeed()
+{
+    double seconds = (hostStart > 0) ? HostTime() - hostStart : 0;
+    double mips = (seconds > 0) ? numInstructions / seconds / 1e6 : 0;
+    int i, total = 0;
+
+    printf("Simulator: %lld instructions in %.3f host seconds, %.2f MIPS\n",
+	numInstructions, seconds, mips);
+    for (i = 0; i < NumSimPhases; i++)
+	total += phaseSamples[i];
+    if (total > 0) {
+	printf("Simulator time:");
+	for (i = 0; i < NumSimPhases; i++)
+	    printf(" %s %.1f%%", phaseNames[i], 100.0 * phaseSamples[i] / total);
+	printf(" (%d samples)\n", total);
+    }
+    if (minMips > 0 && mips < minMips) {
+	printf("Simulator: slower than the minimum of %.2f MIPS\n", minMips);
+	return FALSE;
+    }
+    return TRUE;
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
@@ -29,13 +29,42 @@
 
 // Definitions related to the size, and format of user memory
 
-#define PageSize 	SectorSize 	// set the page size equal to
-					// the disk sector size, for
-					// simplicity
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+// These are set from the command line (-mem, -pagesize, -tlb) before
+// the Machine is built, and must not change afterwards.
 
-#define NumPhysPages     32 //32
+extern int PageSize;			// defaults to the disk sector
+					// size, for simplicity
+extern int NumPhysPages;		// defaults to 32
 #define MemorySize 	(NumPhysPages * PageSize)
-#define TLBSize		4		// if there is a TLB, make it small
+extern int TLBSize;			// if there is a TLB, make it small
+					// (defaults to 4)
+
+// -mips: report how fast the simulator runs on the host, at halt, and
+// fail if it runs at fewer than this many million instructions per
+// second (0 to just report); negative if not asked for.
+extern double minMips;
+
+// What the simulator is doing at the moment, so that we can sample
+// where its host CPU time goes.  SimKernel covers everything outside
+// the instruction interpreter: the Nachos kernel itself, idling, etc.
+enum SimPhase { SimKernel, SimTranslate, SimDecode, SimExecute,
+		SimInterrupt, NumSimPhases };
+
+#define HostSampleUsec	1000		// host CPU time between samples
+
+// Keeping "phase" up to date costs a store or two per instruction, so
+// it is only done while sampling -- and with -DNO_DEBUG, not at all:
+// -mips then reports the speed without the breakdown.
+#ifdef NO_DEBUG
+#define TrackPhase	FALSE
+#else
+#define TrackPhase	sampling
+#endif
+
+#define TextHashSize	251		// buckets for finding shared
+					// text frames
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 enum ExceptionType { NoException,           // Everything ok!
 		     SyscallException,      // A program executed a system call.
@@ -105,6 +134,18 @@ class Instruction {
 // The procedures in this class are defined in machine.cc, mipssim.cc, and
 // translate.cc.
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+// The last page Translate looked up in the linear page table, so that
+// the next access to it is just an add.  "size" is 0 when nothing is
+// remembered, so no address falls in the page.
+class TranslateMemo {
+  public:
+    int page;			// virtual address of the page's first byte
+    int frame;			// ... and its physical address
+    unsigned int size;		// PageSize, or 0
+};
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 class Machine {
   public:
     Machine(bool debug);	// Initialize the simulation of the hardware
@@ -127,13 +168,15 @@ class Machine {
     void DelayedLoad(int nextReg, int nextVal);
 				// Do a pending delayed load (modifying a reg)
 
-    bool ReadMem(int addr, int size, int* value);
+    bool ReadMem(int addr, int size, int* value, bool fetching = FALSE);
     bool WriteMem(int addr, int size, int value);
     				// Read or write 1, 2, or 4 bytes of virtual
 				// memory (at addr).  Return FALSE if a
 				// correct translation couldn't be found.
+				// "fetching" is TRUE for an instruction.
 
-    ExceptionType Translate(int virtAddr, int* physAddr, int size,bool writing);
+    ExceptionType Translate(int virtAddr, int* physAddr, int size,bool writing,
+			    bool fetching = FALSE);
     				// Translate an address, and check for
 				// alignment.  Set the use and dirty bits in
 				// the translation entry appropriately,
@@ -184,11 +227,39 @@ class Machine {
     unsigned int pageTableSize;
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 		BitMap *memoryManagement;
+		int *frameRefs;			// # of page tables mapping each frame
+		void ShareFrame(int frame);	// map an in-use frame once more
+		bool ReleaseFrame(int frame);	// drop one mapping; free the frame
+						// and return TRUE on the last one
+		int FindTextFrame(int file, int fileAddr);
+						// the frame holding the text page
+						// at "fileAddr" in executable
+						// "file", or -1
+		void SetTextFrame(int frame, int file, int fileAddr);
+						// "frame" now holds that page; it
+						// is forgotten when freed
 		TranslationEntry *invertedPageTable;
     unsigned int invertedPageTableSize;
 
 // L6
 		void PCAdvance();
+
+		void FlushTranslateMemo();	// forget the last translations;
+					// call when pageTable or its
+					// entries change
+
+// How fast the simulator itself runs (see -mips)
+    long long numInstructions;	// user instructions completed; 64
+				// bits, as 2^31 takes only minutes
+    double hostStart;		// host time when Run was first called,
+				// 0 until then
+    volatile int phase;		// the SimPhase we are in now
+    volatile int phaseSamples[NumSimPhases];
+				// host CPU samples taken in each phase
+    bool sampling;		// are we taking phaseSamples?
+    void StartSampling();	// take phaseSamples from now on
+    bool PrintSpeed();		// print the figures; FALSE if slower
+				// than minMips
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
   private:
@@ -196,6 +267,19 @@ class Machine {
 				// simulated instruction
     int runUntilTime;		// drop back into the debugger when simulated
 				// time reaches this value
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+		TranslateMemo fetchMemo;	// the last page translated for
+		TranslateMemo readMemo;		// an instruction fetch, a read
+		TranslateMemo writeMemo;	// and a write
+
+		int textBucket[TextHashSize];	// first text frame in each
+						// bucket, -1 if none
+		int *textNext;		// next frame in the same bucket
+		int *textFile;		// executable and file offset each
+		int *textAddr;		// text frame was loaded from; file
+					// -1 if the frame isn't text
+		int TextHash(int file, int fileAddr);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 };
 
 extern void ExceptionHandler(ExceptionType which);
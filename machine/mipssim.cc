@@ -40,6 +40,10 @@ Machine::Run()
 	       currentThread->getName(), stats->totalTicks);
 
     interrupt->setStatus(UserMode);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (hostStart == 0)
+	hostStart = HostTime();		// for -mips
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     for (;;) {
          //cnt ++;
     //if(DebugIsEnabled('m'))
@@ -47,6 +51,10 @@ Machine::Run()
          //printf("%d-with PC %d, ", cnt, machine->ReadRegister(PCReg));
 
          OneInstruction(instr);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+	       if (TrackPhase)
+		   phase = SimInterrupt;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 	       interrupt->OneTick();
 	       if (singleStep && (runUntilTime <= stats->totalTicks))
 	       Debugger();
@@ -108,9 +116,18 @@ Machine::OneInstruction(Instruction *instr)
 				// in the future
 
     // Fetch instruction
-    if (!machine->ReadMem(registers[PCReg], 4, &raw))
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (TrackPhase)
+	phase = SimExecute;		// ReadMem and WriteMem mark the
+					// translations themselves
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (!machine->ReadMem(registers[PCReg], 4, &raw, TRUE))
 	     return;			// exception occurred
     instr->value = raw;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (TrackPhase)
+	phase = SimDecode;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     instr->Decode();
 
     if (DebugIsEnabled('m')) {
@@ -123,6 +140,11 @@ Machine::OneInstruction(Instruction *instr)
        printf("\n");
        }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (TrackPhase)
+	phase = SimExecute;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
     // Compute next pc, but don't install in case there's an error or branch.
     int pcAfter = registers[NextPCReg] + 4;
     int sum, diff, tmp, value;
@@ -541,6 +563,9 @@ Machine::OneInstruction(Instruction *instr)
 	break;
 
       case OP_SYSCALL:
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+	numInstructions++;		// done, as far as the CPU goes
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 	RaiseException(SyscallException, 0);
 	return;
 
@@ -571,6 +596,9 @@ Machine::OneInstruction(Instruction *instr)
 						// are jumping into lala-land
     registers[PCReg] = registers[NextPCReg];
     registers[NextPCReg] = pcAfter;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    numInstructions++;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 }
 
 //----------------------------------------------------------------------
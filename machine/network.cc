@@ -20,12 +20,88 @@ static void NetworkReadPoll(int arg)
 static void NetworkSendDone(int arg)
 { Network *net = (Network *)arg; net->SendDone(); }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+// A packet that has left the wire, on its way to the other end of a link
+class InFlight {
+  public:
+    Network *net;
+    LinkModel *link;
+    char wire[MaxWireSize];
+};
+
+static void NetworkDeliver(int arg)
+{ InFlight *pkt = (InFlight *)arg; pkt->net->Deliver(arg); }
+static void NetworkArrivals(int arg)
+{ Network *net = (Network *)arg; net->TakeArrivals(); }
+
+// Set up a link to "dest" that behaves like the old fixed network
+LinkModel::LinkModel(NetworkAddress dest, double reliability)
+{
+    to = dest;
+    packetTime = NetworkTime;
+    byteTime = 0;
+    latency = jitter = 0;
+    queueLimit = 0;
+    reorder = FALSE;
+    chanceToWork = reliability;
+    inFlight = 0;
+    lastArrival = 0;
+    packetsSent = bytesSent = packetsDropped = packetsLost = 0;
+    firstSend = lastSend = 0;
+    next = NULL;
+}
+
+// set the parameter named "key" to "value"
+void
+LinkModel::Configure(char *key, double value)
+{
+    if (!strcmp(key, "packetTime"))
+	packetTime = (int) value;
+    else if (!strcmp(key, "byteTime"))
+	byteTime = (int) value;
+    else if (!strcmp(key, "latency"))
+	latency = (int) value;
+    else if (!strcmp(key, "jitter"))
+	jitter = (int) value;
+    else if (!strcmp(key, "queueLimit"))
+	queueLimit = (int) value;
+    else if (!strcmp(key, "reorder"))
+	reorder = (value != 0);
+    else if (!strcmp(key, "reliability"))
+	chanceToWork = value;
+    else {
+	fprintf(stderr, "Unknown link parameter \"%s\"\n", key);
+	ASSERT(FALSE);
+    }
+    ASSERT(packetTime > 0 && byteTime >= 0 && latency >= 0 && jitter >= 0
+		&& queueLimit >= 0);
+}
+
+// print what went over the link; throughput is in bytes per 1000 ticks,
+// from the first delivery to the last
+void
+LinkModel::Print(NetworkAddress from)
+{
+    int ticks = lastSend - firstSend;
+
+    printf("Link %d -> %d: %d packets, %d bytes", from, to, packetsSent,
+							bytesSent);
+    if (ticks > 0)
+	printf(" in %d ticks (%d bytes/1000 ticks)", ticks,
+		(int) ((double) bytesSent * 1000 / ticks));
+    printf(", %d dropped (link full), %d lost\n", packetsDropped, packetsLost);
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 // Initialize the network emulation
 //   addr is used to generate the socket name
 //   reliability says whether we drop packets to emulate unreliable links
 //   readAvail, writeDone, callArg -- analogous to console
+//   queueDepth is how many packets can wait to be sent
+//   config is the link configuration file, or NULL
 Network::Network(NetworkAddress addr, double reliability,
-	VoidFunctionPtr readAvail, VoidFunctionPtr writeDone, int callArg)
+	VoidFunctionPtr readAvail, VoidFunctionPtr writeDone, int callArg,
+	int queueDepth, char *config)
 {
     ident = addr;
     if (reliability < 0) chanceToWork = 0;
@@ -37,103 +113,397 @@ Network::Network(NetworkAddress addr, double reliability,
     readHandler = readAvail;
     handlerArg = callArg;
     sendBusy = FALSE;
-    inHdr.length = 0;
+    ASSERT(queueDepth > 0);
+    txDepth = queueDepth;
+    txQueue = new char[txDepth * MaxWireSize];
+    txHead = txCount = 0;
+    linkConfig = config;
+    links = NULL;
+    freeList = rxHead = rxTail = NULL;
+    numFree = NetworkRxBuffers;
+    for (int i = 0; i < NetworkRxBuffers; i++) {
+	rxPool[i].owner = this;
+	rxPool[i].next = freeList;
+	freeList = &rxPool[i];
+    }
     
+    nodeInterrupt = interrupt;
+    arrivals = new List;
+    arrivalsBlocked = FALSE;
+
+    if (cluster != NULL) {		// no socket: the other machines are
+	sock = -1;			// in this process, and hand us their
+	sockName[0] = '\0';		// packets through Arrive
+	cluster->Attach(addr, this);
+	return;
+    }
     sock = OpenSocket();
     sprintf(sockName, "SOCKET_%d", (int)addr);
     AssignNameToSocket(sockName, sock);		 // Bind socket to a filename 
 						 // in the current directory.
 
-    // start polling for incoming packets
-    interrupt->Schedule(NetworkReadPoll, (int)this, NetworkTime, NetworkRecvInt);
+    // have the interrupt simulation watch for incoming packets: it
+    // looks every NetworkTime while busy, and sleeps on the socket
+    // when idle, so no interrupts are scheduled just to poll
+    interrupt->SetInputSource(sock, NetworkReadPoll, (int)this, NetworkTime);
 }
 
 Network::~Network()
 {
-    CloseSocket(sock);
-    DeAssignNameToSocket(sockName);
+    if (sock >= 0) {
+	CloseSocket(sock);
+	DeAssignNameToSocket(sockName);
+    }
+    while (!arrivals->IsEmpty())
+	delete [] (char *)arrivals->Remove();
+    delete arrivals;
+    delete [] txQueue;
+    while (links != NULL) {		// report on each link as it goes
+	LinkModel *link = links;
+	links = link->next;
+	link->Print(ident);
+	delete link;
+    }
 }
 
-// if a packet is already buffered, we simply delay reading 
-// the incoming packet.  In real life, the incoming 
-// packet might be dropped if we can't read it in time.
+// read in every packet that has arrived, as long as there are free
+// receive buffers.  If they are all in use, we simply delay reading the
+// other incoming packets, and stop watching the socket until a buffer
+// is released.  In real life, the incoming packets might be
+// dropped if we can't read them in time.
 void
 Network::CheckPktAvail()
 {
-    // schedule the next time to poll for a packet
-    interrupt->Schedule(NetworkReadPoll, (int)this, NetworkTime, NetworkRecvInt);
-
-    if (inHdr.length != 0) 	// do nothing if packet is already buffered
-	return;		
-    if (!PollSocket(sock)) 	// do nothing if no packet to be read
-	return;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    while (freeList != NULL && RecordedPollSocket(sock)) {
+	PacketBuffer *buffer = freeList;
+	freeList = buffer->next;
+	numFree--;
+	RecordedReadFromSocket(sock, buffer->wire, MaxWireSize);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+	Enqueue(buffer);
+    }
+    if (freeList == NULL)
+	interrupt->WatchInput(FALSE);
+}
 
-    // otherwise, read packet in
-    char *buffer = new char[MaxWireSize];
-    ReadFromSocket(sock, buffer, MaxWireSize);
+// a packet has been read into "buffer", just taken off the free list:
+// queue it for ReceiveBuffer, and tell the post office
+void
+Network::Enqueue(PacketBuffer *buffer)
+{
+    PacketHeader *hdr = buffer->Header();
 
-    // divide packet into header and data
-    inHdr = *(PacketHeader *)buffer;
-    ASSERT((inHdr.to == ident) && (inHdr.length <= MaxPacketSize));
-    bcopy(buffer + sizeof(PacketHeader), inbox, inHdr.length);
-    delete []buffer ;
+    ASSERT((hdr->to == ident) && (hdr->length <= MaxPacketSize));
+    buffer->refs = 1;
+    buffer->next = NULL;
+    if (rxTail == NULL)
+	rxHead = buffer;
+    else
+	rxTail->next = buffer;
+    rxTail = buffer;
 
     DEBUG('n', "Network received packet from %d, length %d...\n",
-	  				(int) inHdr.from, inHdr.length);
+	  				(int) hdr->from, hdr->length);
     stats->numPacketsRecvd++;
 
     // tell post office that the packet has arrived
     (*readHandler)(handlerArg);	
 }
 
-// notify user that another packet can be sent
+// in a cluster, another machine's network has put a packet on its way
+// to us, to arrive at "when".  We may be behind or ahead of the sender
+// (but never by more than the cluster lets us), so schedule the
+// arrival on our own clock
+void
+Network::Arrive(char *wire, int when)
+{
+    char *copy = new char[MaxWireSize];
+
+    bcopy(wire, copy, MaxWireSize);
+    arrivals->SortedInsert(copy, when);
+    nodeInterrupt->ScheduleAt(NetworkArrivals, (int)this, when,
+							NetworkRecvInt);
+}
+
+// take in every packet given to Arrive that is due, as long as there
+// are free receive buffers.  Like CheckPktAvail, if they are all in
+// use, the rest wait until FreeBuffer makes room
+void
+Network::TakeArrivals()
+{
+    int when;
+    char *wire;
+
+    while (freeList != NULL
+	    && (wire = (char *)arrivals->SortedRemove(&when)) != NULL) {
+	if (when > stats->totalTicks) {		// not yet
+	    arrivals->SortedInsert(wire, when);
+	    break;
+	}
+	PacketBuffer *buffer = freeList;
+	freeList = buffer->next;
+	numFree--;
+	bcopy(wire, buffer->wire, MaxWireSize);
+	delete [] wire;
+	Enqueue(buffer);
+    }
+    if (freeList == NULL && !arrivals->IsEmpty())
+	arrivalsBlocked = TRUE;
+}
+
+// the packet at the head of the queue is off the wire: put it on its
+// link, make room for another, start on the next one, and notify user
+// that another packet can be sent
+//
+// on the link, the packet is dropped if the link is full, or lost at
+// random; otherwise it reaches the other end after the link's latency
+// (plus jitter), at which point we hand it to the other machine's socket
 void
 Network::SendDone()
 {
+    char *buffer = txQueue + txHead * MaxWireSize;
+    PacketHeader *hdr = (PacketHeader *)buffer;
+    LinkModel *link = LinkTo(hdr->to);
+
     sendBusy = FALSE;
     stats->numPacketsSent++;
+
+    if (link->queueLimit > 0 && link->inFlight == link->queueLimit) {
+	DEBUG('n', "Link to %d full, dropped packet\n", hdr->to);
+	link->packetsDropped++;
+    } else if (Random() % 100 >= link->chanceToWork * 100) {
+	DEBUG('n', "oops, lost packet to %d!\n", hdr->to);	// emulate a
+	link->packetsLost++;					// lost packet
+    } else {
+	InFlight *pkt = new InFlight;
+	int arrival = stats->totalTicks + link->latency;
+
+	pkt->net = this;
+	pkt->link = link;
+	bcopy(buffer, pkt->wire, MaxWireSize);
+	if (link->jitter > 0)
+	    arrival += Random() % (link->jitter + 1);
+	if (!link->reorder && arrival < link->lastArrival)
+	    arrival = link->lastArrival;	// can't overtake
+	if (cluster != NULL) {		// give the packet to the switch now;
+	    if (arrival < stats->totalTicks + ClusterLookahead)
+		arrival = stats->totalTicks + ClusterLookahead;
+	    cluster->Carry(hdr->to, buffer, arrival);
+	}				// Deliver just keeps the statistics
+	link->lastArrival = arrival;
+	link->inFlight++;
+	if (arrival == stats->totalTicks)
+	    Deliver((int)pkt);
+	else
+	    interrupt->Schedule(NetworkDeliver, (int)pkt,
+			arrival - stats->totalTicks, NetworkSendInt);
+    }
+
+    txHead = (txHead + 1) % txDepth;
+    txCount--;
+    if (txCount > 0)
+	StartSend();
     (*writeHandler)(handlerArg);
 }
 
-// send a packet by concatenating hdr and data, and schedule
-// an interrupt to tell the user when the next packet can be sent 
-//
-// Note we always pad out a packet to MaxWireSize before putting it into
-// the socket, because it's simpler at the receive end.
+// a packet has reached the other end of its link: send it out to
+// the socket of the machine there (in a cluster, the switch already
+// has it)
 void
-Network::Send(PacketHeader hdr, char* data)
+Network::Deliver(int arg)
 {
+    InFlight *pkt = (InFlight *)arg;
+    LinkModel *link = pkt->link;
+    PacketHeader *hdr = (PacketHeader *)pkt->wire;
     char toName[32];
 
-    sprintf(toName, "SOCKET_%d", (int)hdr.to);
-    
-    ASSERT((sendBusy == FALSE) && (hdr.length > 0) 
-		&& (hdr.length <= MaxPacketSize) && (hdr.from == ident));
-    DEBUG('n', "Sending to addr %d, %d bytes... ", hdr.to, hdr.length);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (sock >= 0 && (replay == NULL || !replay->Replaying())) {
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+	sprintf(toName, "SOCKET_%d", (int)hdr->to);
+	SendToSocket(sock, pkt->wire, MaxWireSize, toName);
+    }
+    DEBUG('n', "Delivered packet to %d, %d bytes\n", hdr->to, hdr->length);
 
-    interrupt->Schedule(NetworkSendDone, (int)this, NetworkTime, NetworkSendInt);
+    if (link->packetsSent++ == 0)
+	link->firstSend = stats->totalTicks;
+    link->lastSend = stats->totalTicks;
+    link->bytesSent += hdr->length;
+    link->inFlight--;
+    delete pkt;
+}
 
-    if (Random() % 100 >= chanceToWork * 100) { // emulate a lost packet
-	DEBUG('n', "oops, lost it!\n");
-	return;
+// find the link to machine "to", setting it up if this is the first
+// packet for it: start from the defaults, then apply every line of the
+// configuration file that matches the link
+LinkModel *
+Network::LinkTo(NetworkAddress to)
+{
+    LinkModel *link;
+    char line[256];
+    FILE *config;
+
+    for (link = links; link != NULL; link = link->next)
+	if (link->to == to)
+	    return link;
+
+    link = new LinkModel(to, chanceToWork);
+    link->next = links;
+    links = link;
+    if (linkConfig == NULL)
+	return link;
+
+    config = fopen(linkConfig, "r");
+    ASSERT(config != NULL);
+    while (fgets(line, sizeof(line), config) != NULL) {
+	char *from, *dest, *key, *value;
+
+	if (strchr(line, '#') != NULL)
+	    *strchr(line, '#') = '\0';
+	from = strtok(line, " \t\n");
+	dest = strtok(NULL, " \t\n");
+	if (from == NULL || dest == NULL)
+	    continue;			// blank line
+	if ((strcmp(from, "*") && atoi(from) != ident)
+			|| (strcmp(dest, "*") && atoi(dest) != to))
+	    continue;			// some other link
+	while ((key = strtok(NULL, " \t\n")) != NULL) {
+	    value = strtok(NULL, " \t\n");
+	    ASSERT(value != NULL);
+	    link->Configure(key, atof(value));
+	}
     }
+    fclose(config);
+    DEBUG('n', "Link to %d: %d+%d/byte ticks, latency %d+%d, limit %d\n",
+		to, link->packetTime, link->byteTime, link->latency,
+		link->jitter, link->queueLimit);
+    return link;
+}
+
+// put a packet in the transmit queue, by concatenating hdr and data
+// into a free slot, and start sending it if the wire is free
+//
+// Note we always pad out a packet to MaxWireSize before putting it into
+// the socket, because it's simpler at the receive end.
+void
+Network::Send(PacketHeader hdr, char* data)
+{
+    Send(hdr, NULL, 0, data);
+}
 
-    // concatenate hdr and data into a single buffer, and send it out
-    char *buffer = new char[MaxWireSize];
+// send a packet whose data is in two pieces, "prefix" and "data"
+void
+Network::Send(PacketHeader hdr, char *prefix, int prefixLength, char *data)
+{
+    ASSERT((txCount < txDepth) && (hdr.length > 0)
+		&& (hdr.length <= MaxPacketSize) && (hdr.from == ident)
+		&& (prefixLength <= (int) hdr.length));
+    DEBUG('n', "Queueing for addr %d, %d bytes, %d ahead\n", hdr.to,
+						hdr.length, txCount);
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);	// SendDone changes
+							// the queue too
+    char *buffer = txQueue + ((txHead + txCount) % txDepth) * MaxWireSize;
     *(PacketHeader *)buffer = hdr;
-    bcopy(data, buffer + sizeof(PacketHeader), hdr.length);
-    SendToSocket(sock, buffer, MaxWireSize, toName);
-    delete []buffer;
+    if (prefixLength > 0)
+	bcopy(prefix, buffer + sizeof(PacketHeader), prefixLength);
+    bcopy(data, buffer + sizeof(PacketHeader) + prefixLength,
+						hdr.length - prefixLength);
+    txCount++;
+    if (!sendBusy)
+	StartSend();
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+// the wire is free: start sending the packet at the head of the queue,
+// and schedule an interrupt to tell us when it is off the wire (which
+// takes as long as its link says, whether or not the packet is lost)
+void
+Network::StartSend()
+{
+    PacketHeader *hdr = (PacketHeader *)(txQueue + txHead * MaxWireSize);
+
+    sendBusy = TRUE;
+    DEBUG('n', "Sending to addr %d, %d bytes\n", hdr->to, hdr->length);
+    interrupt->Schedule(NetworkSendDone, (int)this,
+		LinkTo(hdr->to)->WireTime(hdr->length), NetworkSendInt);
 }
 
 // read a packet, if one is buffered
 PacketHeader
 Network::Receive(char* data)
 {
-    PacketHeader hdr = inHdr;
+    PacketBuffer *buffer = ReceiveBuffer();
+    PacketHeader hdr;
 
-    inHdr.length = 0;
-    if (hdr.length != 0)
-    	bcopy(inbox, data, hdr.length);
+    if (buffer == NULL) {
+	hdr.length = 0;
+	return hdr;
+    }
+    hdr = *buffer->Header();
+    bcopy(buffer->Data(), data, hdr.length);
+    buffer->Release();
     return hdr;
 }
+
+// take the oldest arrived packet, buffer and all
+PacketBuffer *
+Network::ReceiveBuffer()
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    PacketBuffer *buffer = rxHead;
+
+    if (buffer != NULL) {
+	rxHead = buffer->next;
+	if (rxHead == NULL)
+	    rxTail = NULL;
+    }
+    (void) interrupt->SetLevel(oldLevel);
+    return buffer;
+}
+
+// put a buffer nobody holds any more back in the pool; called from
+// threads, so keep the interrupt handler out while we do it
+void
+Network::FreeBuffer(PacketBuffer *buffer)
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    buffer->next = freeList;
+    freeList = buffer;
+    numFree++;
+    if (buffer->next == NULL)
+	interrupt->WatchInput(TRUE);	// room again for what's waiting
+    if (arrivalsBlocked) {
+	arrivalsBlocked = FALSE;
+	interrupt->Schedule(NetworkArrivals, (int)this, 1, NetworkRecvInt);
+    }
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+// give up a reference to a received packet
+void
+PacketBuffer::Release()
+{
+    ASSERT(refs > 0);
+    if (--refs == 0) {
+	if (owner == NULL)
+	    delete this;		// a Copy, not from any pool
+	else
+	    owner->FreeBuffer(this);
+    }
+}
+
+// copy a received packet out of the pool, for someone who may hold on
+// to it for a long time; the copy is released like any other buffer
+PacketBuffer *
+PacketBuffer::Copy()
+{
+    PacketBuffer *copy = new PacketBuffer;
+
+    bcopy(wire, copy->wire, MaxWireSize);
+    copy->refs = 1;
+    copy->owner = NULL;
+    copy->next = NULL;
+    return copy;
+}
@@ -18,6 +18,11 @@
 #include "copyright.h"
 #include "utility.h"
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+class List;
+class Interrupt;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 // Network address -- uniquely identifies a machine.  This machine's ID 
 //  is given on the command line.
 typedef int NetworkAddress;	 
@@ -40,7 +45,88 @@ class PacketHeader {
 #define MaxWireSize 	64	// largest packet that can go out on the wire
 #define MaxPacketSize 	(MaxWireSize - sizeof(struct PacketHeader))	
 				// data "payload" of the largest packet
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#define NetworkRxBuffers 32	// packets that can be held on this machine
+				// before anyone has taken them
+#define NetworkTxQueue	8	// default # packets that can wait to go
+				// out on the wire
+
+class Network;
+
+// The following class defines a buffer for one received packet, as it
+// came off the wire.  The buffers come out of a fixed pool belonging to
+// the network device, and are passed up to whoever receives the
+// packet, instead of the packet being copied at every step.  Anyone
+// holding on to a buffer counts as a reference; when the last one lets
+// go, the buffer goes back to the pool.
 
+class PacketBuffer {
+  public:
+    PacketHeader *Header() { return (PacketHeader *) wire; }
+    char *Data() { return wire + sizeof(PacketHeader); }
+				// the packet, as it came off the wire
+    void Ref() { refs++; }	// one more holder
+    void Release();		// one holder fewer; back to the pool
+				// when there are none
+    PacketBuffer *Copy();	// a copy of the packet, held once, on
+				// the heap instead of from the pool
+
+  private:
+    friend class Network;
+    char wire[MaxWireSize];	// must come first, to be aligned for
+				// the headers
+    int refs;
+    Network *owner;		// whose pool we are from; NULL for a copy
+    PacketBuffer *next;		// on the free list or arrival queue
+};
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+// The following class defines the model of the link from this machine
+// to one other machine.  A packet takes
+//	packetTime + length * byteTime
+// to put on the wire (length counts the packet data), then "latency"
+// ticks, plus up to "jitter" more, to reach the other end.  At most
+// "queueLimit" packets can be on the link at once; a packet that
+// finds it full is dropped (tail drop).  Unless "reorder" is set,
+// packets arrive in the order they were sent, whatever their jitter.
+//
+// By default a link behaves like the old fixed network: NetworkTime
+// per packet, no latency, no limit.  A link configuration file,
+// given with -netcfg, changes that.  Each line of the file is
+//	from to key value key value ...
+// where "from" and "to" are machine ids or "*" for any, and the keys
+// are the field names below (plus "reliability").  Later lines
+// override earlier ones; "#" starts a comment.
+
+class LinkModel {
+  public:
+    LinkModel(NetworkAddress dest, double reliability);
+
+    int WireTime(int length) { return packetTime + length * byteTime; }
+    void Configure(char *key, double value);	// set one parameter
+    void Print(NetworkAddress from);		// the link's statistics
+
+    NetworkAddress to;		// the machine at the other end
+    int packetTime;		// ticks to send a packet, whatever its size
+    int byteTime;		// ... and for each byte of data
+    int latency;		// ticks from the wire to the other end
+    int jitter;			// up to this many ticks more, at random
+    int queueLimit;		// most packets on the link; 0 = no limit
+    bool reorder;		// may packets overtake each other?
+    double chanceToWork;	// likelihood a packet gets through
+
+    int inFlight;		// # packets on the link now
+    int lastArrival;		// when the latest packet will arrive
+
+    int packetsSent, bytesSent;	// delivered to the other end
+    int packetsDropped;		// dropped because the link was full
+    int packetsLost;		// lost at random
+    int firstSend, lastSend;	// ticks of the first and last delivery
+
+    LinkModel *next;		// other links from this machine
+};
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 // The following class defines a physical network device.  The network
 // is capable of delivering fixed sized packets, in order but unreliably, 
@@ -55,30 +141,74 @@ class PacketHeader {
 class Network {
   public:
     Network(NetworkAddress addr, double reliability,
-  	  VoidFunctionPtr readAvail, VoidFunctionPtr writeDone, int callArg);
-				// Allocate and initialize network driver
+  	  VoidFunctionPtr readAvail, VoidFunctionPtr writeDone, int callArg,
+	  int queueDepth = NetworkTxQueue, char *linkConfig = NULL);
+				// Allocate and initialize network driver;
+				// up to "queueDepth" packets can be queued
+				// for sending at once.  "linkConfig" names
+				// the link configuration file, if any.
     ~Network();			// De-allocate the network driver data
     
     void Send(PacketHeader hdr, char* data);
     				// Send the packet data to a remote machine,
 				// specified by "hdr".  Returns immediately.
-    				// "writeHandler" is invoked once the next 
-				// packet can be sent.  Note that writeHandler 
+				// The packet joins the transmit queue, which
+				// must not be full; packets go out one per
+				// NetworkTime.  "writeHandler" is invoked
+				// each time a packet has gone out, making
+				// room in the queue.  Note that writeHandler 
 				// is called whether or not the packet is 
 				// dropped, and note that the "from" field of 
 				// the PacketHeader is filled in automatically 
 				// by Send().
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    void Send(PacketHeader hdr, char *prefix, int prefixLength, char *data);
+				// Same, but the packet data is "prefixLength"
+				// bytes at "prefix" followed by the rest at
+				// "data", so a higher layer's header needn't
+				// be pasted on in a buffer of its own
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     PacketHeader Receive(char* data);
     				// Poll the network for incoming messages.  
 				// If there is a packet waiting, copy the 
 				// packet into "data" and return the header.
 				// If no packet is waiting, return a header 
-				// with length 0.
+				// with length 0.  Packets come out in the
+				// order they arrived.
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    PacketBuffer *ReceiveBuffer();
+				// Like Receive, but hand over the buffer the
+				// packet arrived in, without copying it; NULL
+				// if no packet is waiting.  The caller must
+				// Release the buffer when done with it.
+    void FreeBuffer(PacketBuffer *buffer);
+				// Put a buffer back in the pool (called by
+				// PacketBuffer::Release)
+    int NumFreeBuffers() { return numFree; }
+				// # buffers left in the pool
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     void SendDone();		// Interrupt handler, called when message is 
 				// sent
-    void CheckPktAvail();	// Check if there is an incoming packet
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    void Deliver(int arg);	// Interrupt handler, called when a packet
+				// reaches the other end of its link
+    int QueueDepth() { return txDepth; }
+				// # packets the transmit queue can hold
+    bool QueueFull() { return txCount == txDepth; }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    void CheckPktAvail();	// Take in whatever packets have arrived;
+				// called by the interrupt simulation when
+				// the socket has something to read
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    void Arrive(char *wire, int when);
+				// In a cluster (see cluster.h), instead of
+				// the socket: a packet that will arrive at
+				// time "when" on this machine's clock
+    void TakeArrivals();	// Interrupt handler, called when packets
+				// given to Arrive are due
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
   private:
     NetworkAddress ident;	// This machine's network address
@@ -91,11 +221,39 @@ class Network {
 				// 	arrived.
     int handlerArg;		// Argument to be passed to interrupt handler
 				//   (pointer to post office)
-    bool sendBusy;		// Packet is being sent.
-    bool packetAvail;		// Packet has arrived, can be pulled off of
-				//   network
-    PacketHeader inHdr;		// Information about arrived packet
-    char inbox[MaxPacketSize];  // Data for arrived packet
+    bool sendBusy;		// Packet is being sent (the one at the
+				// head of the transmit queue).
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    PacketBuffer rxPool[NetworkRxBuffers];
+				// Buffers to read packets into
+    PacketBuffer *freeList;	// Buffers in rxPool nobody is using
+    int numFree;		// # of them
+    PacketBuffer *rxHead;	// Arrived packets, oldest first, not yet
+    PacketBuffer *rxTail;	//   taken by ReceiveBuffer
+    char *txQueue;		// Packets waiting to go out, MaxWireSize
+				// bytes each; a circular queue
+    int txDepth;		// # packets txQueue can hold
+    int txHead;			// Packet now being sent
+    int txCount;		// # packets in txQueue
+
+    void StartSend();		// Put the packet at the head of the
+				// transmit queue on the wire
+
+    void Enqueue(PacketBuffer *buffer);
+				// A packet has been read into "buffer": queue
+				// it for ReceiveBuffer, and tell the user
+
+    Interrupt *nodeInterrupt;	// This machine's interrupts; in a cluster
+				// "interrupt" may belong to another machine
+    List *arrivals;		// Packets given to Arrive, not yet taken
+				// in, sorted by arrival time
+    bool arrivalsBlocked;	// Packets are due, but the pool is empty
+
+    char *linkConfig;		// Link configuration file, or NULL
+    LinkModel *links;		// Links we have sent on so far
+    LinkModel *LinkTo(NetworkAddress to);
+				// The link to "to", set up on first use
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 };
 
 #endif // NETWORK_H
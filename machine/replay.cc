@@ -0,0 +1,334 @@
+// replay.cc
+//	Routines to record the nondeterministic inputs of a run, and to
+//	replay them.  See replay.h.
+//
+//	Each entry in the log starts with a byte holding its ReplayKind,
+//	plus ReplayRepeated if the value comes more than once in a row.
+//	Then comes the value, and then, if repeated, how many times.
+//	Numbers are "zig-zag" encoded (so small negative numbers are
+//	small too) and then stored 7 bits to a byte, low bits first, with
+//	the top bit of each byte set if more bytes follow.
+//
+//  DO NOT CHANGE -- part of the machine emulation
+
+#include "copyright.h"
+#include "system.h"
+#include "replay.h"
+
+class ReplayFileHeader {
+  public:
+    int magic;			// ReplayMagic
+    int version;		// ReplayVersion
+};
+
+static char *replayKindNames[] = { "random number", "poll", "read count",
+					"bytes", "end" };
+
+//----------------------------------------------------------------------
+// Replay::Replay
+// 	Start recording a log into "fileName" (replacing any old one), or
+//	open it to replay.
+//
+//	"fileName" -- UNIX file to hold the log
+//	"replayIt" -- TRUE to replay the log, FALSE to record it
+//----------------------------------------------------------------------
+
+Replay::Replay(char *fileName, bool replayIt)
+{
+    ReplayFileHeader hdr;
+
+    replaying = replayIt;
+    buffer = new char[ReplayBufferSize];
+    used = length = count = 0;
+    runKind = -1;
+    runValue = runLength = 0;
+
+    if (replaying) {
+	file = OpenForReadWrite(fileName, TRUE);
+	Read(file, (char *) &hdr, sizeof(hdr));
+	if (hdr.magic != ReplayMagic || hdr.version != ReplayVersion) {
+	    fprintf(stderr, "%s: not a Nachos replay log (or from another "
+		"host)\n", fileName);
+	    Exit(1);
+	}
+    } else {
+	file = OpenForWrite(fileName);
+	hdr.magic = ReplayMagic;
+	hdr.version = ReplayVersion;
+	WriteFile(file, (char *) &hdr, sizeof(hdr));
+    }
+}
+
+//----------------------------------------------------------------------
+// Replay::~Replay
+// 	Finish the log.  When recording, note the time we stopped and
+//	write out the rest.  When replaying, check that we stopped at the
+//	same time as the recorded run.
+//----------------------------------------------------------------------
+
+Replay::~Replay()
+{
+    if (replaying) {
+	int when = Value(ReplayEnd, 0);
+
+	if (when != stats->totalTicks) {
+	    printf("Replay: the recorded run stopped at tick %d, this one "
+		"at %d\n", when, stats->totalTicks);
+	    Diverged("end");
+	}
+	printf("Replay: %d inputs replayed, stopped at the same tick, %d\n",
+	    count, when);
+    } else {
+	Value(ReplayEnd, stats->totalTicks);
+	EndRun();
+	Flush();
+	printf("Replay: %d inputs recorded\n", count);
+    }
+    Close(file);
+    delete [] buffer;
+}
+
+//----------------------------------------------------------------------
+// Replay::Value
+// 	Record a value, or replay one.
+//
+//	"kind" -- what the value is
+//	"value" -- when recording, the value to log (ignored when replaying)
+//
+//	Returns the value: the one logged, or the one replayed.
+//----------------------------------------------------------------------
+
+int
+Replay::Value(ReplayKind kind, int value)
+{
+    count++;
+    if (replaying) {
+	if (runLength == 0)
+	    NextRun(kind);
+	else if (runKind != kind)
+	    Diverged(replayKindNames[kind]);
+	runLength--;
+	return runValue;
+    }
+    if (runLength > 0 && (runKind != kind || runValue != value))
+	EndRun();
+    runKind = kind;
+    runValue = value;
+    runLength++;
+    return value;
+}
+
+//----------------------------------------------------------------------
+// Replay::Bytes
+// 	Record "size" bytes of input at "data", or replay them into
+//	"data".  The bytes are logged as they are, after the count.
+//----------------------------------------------------------------------
+
+void
+Replay::Bytes(char *data, int size)
+{
+    int i;
+
+    count++;
+    if (replaying) {
+	if (runLength != 0)
+	    Diverged(replayKindNames[ReplayBytes]);
+	NextRun(ReplayBytes);
+	runLength = 0;
+	if (runValue != size)
+	    Diverged(replayKindNames[ReplayBytes]);
+	for (i = 0; i < size; i++) {
+	    int c = GetByte();
+	    if (c < 0)
+		Diverged(replayKindNames[ReplayBytes]);
+	    data[i] = c;
+	}
+	return;
+    }
+    EndRun();
+    PutByte(ReplayBytes);
+    PutNumber(size);
+    for (i = 0; i < size; i++)
+	PutByte(data[i]);
+}
+
+//----------------------------------------------------------------------
+// Replay::EndRun
+// 	Write out the run of equal values collected so far, if any.
+//----------------------------------------------------------------------
+
+void
+Replay::EndRun()
+{
+    if (runLength == 0)
+	return;
+    PutByte(runKind | ((runLength > 1) ? ReplayRepeated : 0));
+    PutNumber(runValue);
+    if (runLength > 1)
+	PutNumber(runLength);
+    runLength = 0;
+}
+
+//----------------------------------------------------------------------
+// Replay::NextRun
+// 	Read the next entry of the log, which had better be of kind
+//	"kind".  For ReplayBytes, runValue is the number of bytes, which
+//	the caller then reads.
+//----------------------------------------------------------------------
+
+void
+Replay::NextRun(ReplayKind kind)
+{
+    int first = GetByte();
+
+    if (first < 0 || (first & ~ReplayRepeated) != kind)
+	Diverged(replayKindNames[kind]);
+    runKind = kind;
+    runValue = GetNumber();
+    runLength = (first & ReplayRepeated) ? GetNumber() : 1;
+}
+
+//----------------------------------------------------------------------
+// Replay::Diverged
+// 	The replayed run asked for something the recorded one didn't (or
+//	the log is cut short).  There's no point going on.
+//----------------------------------------------------------------------
+
+void
+Replay::Diverged(char *what)
+{
+    fprintf(stderr, "Replay: diverged from the recorded run at input %d "
+	"(%s), tick %d\n", count, what, stats->totalTicks);
+    Exit(1);
+}
+
+//----------------------------------------------------------------------
+// Replay::PutByte, GetByte, PutNumber, GetNumber
+// 	Write or read the log, a byte or a number at a time.
+//----------------------------------------------------------------------
+
+void
+Replay::PutByte(int c)
+{
+    if (used == ReplayBufferSize)
+	Flush();
+    buffer[used++] = c;
+}
+
+int
+Replay::GetByte()
+{
+    if (used == length) {
+	length = ReadPartial(file, buffer, ReplayBufferSize);
+	used = 0;
+	if (length <= 0) {
+	    length = 0;
+	    return -1;			// end of the log
+	}
+    }
+    return buffer[used++] & 0xff;
+}
+
+void
+Replay::PutNumber(int n)
+{
+    unsigned int zigzag = ((unsigned int) n << 1) ^ (n >> 31);
+
+    while (zigzag >= 0x80) {
+	PutByte((zigzag & 0x7f) | 0x80);
+	zigzag >>= 7;
+    }
+    PutByte(zigzag);
+}
+
+int
+Replay::GetNumber()
+{
+    unsigned int zigzag = 0;
+    int shift = 0, c;
+
+    do {
+	if ((c = GetByte()) < 0)
+	    Diverged("number");
+	zigzag |= (c & 0x7f) << shift;
+	shift += 7;
+    } while (c & 0x80);
+    return (zigzag >> 1) ^ -(int)(zigzag & 1);
+}
+
+//----------------------------------------------------------------------
+// Replay::Flush
+// 	Write the buffered log to the file, emptying the buffer.
+//----------------------------------------------------------------------
+
+void
+Replay::Flush()
+{
+    if (used == 0)
+	return;
+    WriteFile(file, buffer, used);
+    used = 0;
+}
+
+//----------------------------------------------------------------------
+// RecordedPollFile, RecordedReadPartial, RecordedWaitForFile,
+// RecordedPollSocket, RecordedReadFromSocket
+// 	Get input from outside Nachos, as the sysdep routine of the same
+//	name does -- and log it, if -record; or, if -replay, don't ask
+//	the host at all, but hand back what was logged.
+//----------------------------------------------------------------------
+
+bool
+RecordedPollFile(int fd)
+{
+    if (replay == NULL)
+	return PollFile(fd);
+    if (replay->Replaying())
+	return replay->Value(ReplayPoll, 0);
+    return replay->Value(ReplayPoll, PollFile(fd));
+}
+
+int
+RecordedReadPartial(int fd, char *buffer, int nBytes)
+{
+    int n;
+
+    if (replay == NULL)
+	return ReadPartial(fd, buffer, nBytes);
+    if (replay->Replaying())
+	n = replay->Value(ReplayCount, 0);
+    else
+	n = replay->Value(ReplayCount, ReadPartial(fd, buffer, nBytes));
+    if (n > 0)
+	replay->Bytes(buffer, n);
+    return n;
+}
+
+bool
+RecordedWaitForFile(int fd, int usec)
+{
+    if (replay == NULL)
+	return WaitForFile(fd, usec);
+    if (replay->Replaying())
+	return replay->Value(ReplayPoll, 0);
+    return replay->Value(ReplayPoll, WaitForFile(fd, usec));
+}
+
+bool
+RecordedPollSocket(int sockID)
+{
+    if (replay == NULL)
+	return PollSocket(sockID);
+    if (replay->Replaying())
+	return replay->Value(ReplayPoll, 0);
+    return replay->Value(ReplayPoll, PollSocket(sockID));
+}
+
+void
+RecordedReadFromSocket(int sockID, char *buffer, int packetSize)
+{
+    if (replay == NULL || !replay->Replaying())
+	ReadFromSocket(sockID, buffer, packetSize);
+    if (replay != NULL)
+	replay->Bytes(buffer, packetSize);
+}
@@ -0,0 +1,115 @@
+// replay.h
+//	Data structures to record the nondeterministic inputs of a run of
+//	Nachos, and feed them back in to a later run, so that the two runs
+//	do exactly the same thing, tick for tick.
+//
+//	Everything else Nachos does is a function of its flags and its
+//	files (the DISK, the user programs, ...).  The inputs that are not
+//	are:
+//		the pseudo-random numbers drawn by Random -- for -rs random
+//		  yields, lost packets and network jitter, thread priorities
+//		whether the console or the network had input when we looked
+//		  (PollFile, WaitForFile, PollSocket)
+//		the console characters and network packets read in
+//
+//	"nachos -record <file> ..." logs each of these, in the order they
+//	are asked for.  "nachos -replay <file> ...", with the same flags
+//	otherwise, hands back the logged values instead of asking the
+//	host.  A replayed run never waits for input, and doesn't send
+//	packets to other machines, which aren't there to take them.
+//
+//	The log is compact: numbers are stored in a variable number of
+//	bytes, and a run of equal values -- the console polled and found
+//	empty a thousand times, say -- is stored once, with a count.  The
+//	recording ends with the tick count at which Nachos stopped, so
+//	the replay can check that it stopped at the same tick.  If the
+//	replayed run asks for a different kind of value than the log
+//	has next, it has diverged (the build, the flags or the files
+//	changed), and we stop.
+//
+//  DO NOT CHANGE -- part of the machine emulation
+
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// The kinds of value in the log.  Kept in the low bits of the byte
+// that starts each entry.
+
+enum ReplayKind {
+    ReplayRandom,		// a number from Random
+    ReplayPoll,			// 1 if a device had input, 0 if not
+    ReplayCount,		// what ReadPartial returned
+    ReplayBytes,		// the bytes read in: a count, then the
+				//	bytes themselves
+    ReplayEnd,			// stats->totalTicks when we stopped
+    NumReplayKinds
+};
+
+#define ReplayRepeated	0x80		// in the first byte of an entry:
+					// a repeat count follows the value
+
+#define ReplayMagic	0x4c50524e	// "NRPL", in the host's byte order
+#define ReplayVersion	1
+#define ReplayBufferSize 16384		// bytes of log kept in memory
+
+// The following class defines a log being recorded or replayed.
+
+class Replay {
+  public:
+    Replay(char *fileName, bool replayIt);
+				// Record into "fileName", or (if
+				// "replayIt") replay from it
+    ~Replay();			// Finish the log: write out (or check)
+				// the final tick count
+
+    bool Replaying() { return replaying; }
+
+    int Value(ReplayKind kind, int value);
+				// Recording: log "value" and return it.
+				// Replaying: return the logged value
+				// instead, which must be of this kind
+    void Bytes(char *data, int size);
+				// Log data[0..size), or fill it in
+    int Count() { return count; }
+				// # values logged or replayed so far
+
+  private:
+    int file;			// UNIX file descriptor of the log
+    bool replaying;
+    char *buffer;		// log bytes not yet written (recording),
+    int used;			// or not yet used (replaying)
+    int length;			// replaying: # bytes read into buffer
+    int count;
+
+    int runKind;		// the run of equal values being
+    int runValue;		// collected (recording) or handed
+    int runLength;		// out (replaying); runLength 0 if none
+
+    void EndRun();		// write out the run being collected
+    void NextRun(ReplayKind kind);
+				// read the next entry, which should be
+				// of kind "kind"
+    void Diverged(char *what);	// stop: the run went another way
+
+    void PutByte(int c);
+    int GetByte();		// -1 at the end of the log
+    void PutNumber(int n);
+    int GetNumber();
+    void Flush();		// write the buffer out to the file
+};
+
+extern Replay *replay;		// NULL unless -record or -replay
+
+// Stand-ins for the sysdep routines that get input from outside Nachos:
+// without -record or -replay, they just call the real ones.
+
+extern bool RecordedPollFile(int fd);
+extern int RecordedReadPartial(int fd, char *buffer, int nBytes);
+extern bool RecordedWaitForFile(int fd, int usec);
+extern bool RecordedPollSocket(int sockID);
+extern void RecordedReadFromSocket(int sockID, char *buffer, int packetSize);
+
+#endif // REPLAY_H
@@ -22,6 +22,9 @@ Statistics::Statistics()
     numDiskReads = numDiskWrites = 0;
     numConsoleCharsRead = numConsoleCharsWritten = 0;
     numPageFaults = numPacketsSent = numPacketsRecvd = 0;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    numTlbMisses = 0;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 }
 
 //----------------------------------------------------------------------
@@ -38,7 +41,69 @@ Statistics::Print()
     printf("Disk I/O: reads %d, writes %d\n", numDiskReads, numDiskWrites);
     printf("Console I/O: reads %d, writes %d\n", numConsoleCharsRead, 
 	numConsoleCharsWritten);
-    printf("Paging: faults %d\n", numPageFaults);
+    printf("Paging: faults %d, TLB misses %d\n", numPageFaults, numTlbMisses);
     printf("Network I/O: packets received %d, sent %d\n", numPacketsRecvd, 
 	numPacketsSent);
 }
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// UsageStats::UsageStats
+// 	Initialize a thread's (or program's) usage to zero.
+//----------------------------------------------------------------------
+
+UsageStats::UsageStats()
+{
+    userTicks = systemTicks = 0;
+    voluntarySwitches = involuntarySwitches = 0;
+    numPageFaults = numTlbMisses = 0;
+    numSectorsRead = numSectorsWritten = 0;
+    for (int i = 0; i < NumSyscallCodes; i++)
+	numSyscalls[i] = 0;
+}
+
+//----------------------------------------------------------------------
+// UsageStats::Add
+// 	Add the usage of "other" into ours; used to total up the threads
+//	of a program.
+//----------------------------------------------------------------------
+
+void
+UsageStats::Add(UsageStats *other)
+{
+    userTicks += other->userTicks;
+    systemTicks += other->systemTicks;
+    voluntarySwitches += other->voluntarySwitches;
+    involuntarySwitches += other->involuntarySwitches;
+    numPageFaults += other->numPageFaults;
+    numTlbMisses += other->numTlbMisses;
+    numSectorsRead += other->numSectorsRead;
+    numSectorsWritten += other->numSectorsWritten;
+    for (int i = 0; i < NumSyscallCodes; i++)
+	numSyscalls[i] += other->numSyscalls[i];
+}
+
+//----------------------------------------------------------------------
+// UsageStats::Print
+// 	Print the usage, on a few lines headed by "who".  Only the system
+//	calls that were made are listed.
+//----------------------------------------------------------------------
+
+void
+UsageStats::Print(char *who)
+{
+    printf("%s:\n", who);
+    printf("  Ticks: system %d, user %d\n", systemTicks, userTicks);
+    printf("  Context switches: voluntary %d, involuntary %d\n",
+	voluntarySwitches, involuntarySwitches);
+    printf("  Paging: faults %d, TLB misses %d\n", numPageFaults,
+	numTlbMisses);
+    printf("  Disk: sectors read %d, written %d\n", numSectorsRead,
+	numSectorsWritten);
+    printf("  System calls:");
+    for (int i = 0; i < NumSyscallCodes; i++)
+	if (numSyscalls[i] > 0)
+	    printf(" %d:%d", i, numSyscalls[i]);
+    printf("\n");
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
@@ -33,6 +33,9 @@ class Statistics {
     int numConsoleCharsRead;	// number of characters read from the keyboard
     int numConsoleCharsWritten; // number of characters written to the display
     int numPageFaults;		// number of virtual memory page faults
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    int numTlbMisses;		// number of TLB misses
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     int numPacketsSent;		// number of packets sent over the network
     int numPacketsRecvd;	// number of packets received over the network
 
@@ -41,6 +44,35 @@ class Statistics {
     void Print();		// print collected statistics
 };
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+// The following class defines the statistics kept for one thread, and
+// summed for all the threads of one user program (one AddrSpace), so
+// that the global figures above can be attributed to someone.
+//
+// The fields are all ints, laid out just like the Usage structure in
+// syscall.h, which is what the GetUsage system call copies out.
+
+#define NumSyscallCodes	32	// room for every code in syscall.h
+
+class UsageStats {
+  public:
+    int userTicks;		// user instructions executed
+    int systemTicks;		// time in the kernel, on our behalf
+    int voluntarySwitches;	// context switches because we blocked
+    int involuntarySwitches;	// ... while we could have kept running
+    int numPageFaults;		// page faults we took
+    int numTlbMisses;		// TLB misses we took
+    int numSectorsRead;		// disk sectors read for us
+    int numSectorsWritten;	// disk sectors written for us
+    int numSyscalls[NumSyscallCodes];	// system calls, by code
+
+    UsageStats(); 		// initialize everything to zero
+
+    void Add(UsageStats *other);	// add "other" into this
+    void Print(char *who);	// print, labelled with "who"
+};
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 // Constants used to reflect the relative time an operation would
 // take in a real system.  A "tick" is a just a unit of time -- if you 
 // like, a microsecond.
@@ -1,28 +1,80 @@
 // for L5E6
 #include "synchconsole.h"
 
-static Semaphore *readAvail = new Semaphore("read avail", 0);
-static Semaphore *writeDone = new Semaphore("write done", 0);
-static void ReadAvail(int arg) { readAvail->V(); }
-static void WriteDone(int arg) { writeDone->V(); }
+static void ReadAvail(int arg) { ((SynchConsole *)arg)->ReadAvail(); }
+static void WriteDone(int arg) { ((SynchConsole *)arg)->WriteDone(); }
 
 
 SynchConsole::SynchConsole(char *readFile, char *writeFile) {
-    lock = new Lock("console");
-    console = new Console(readFile, writeFile, ReadAvail, WriteDone, 0);
+    readLock = new Lock("console read");
+    writeLock = new Lock("console write");
+    readAvail = new Semaphore("read avail", 0);
+    writeDone = new Semaphore("write done", 0);
+    console = new Console(readFile, writeFile, ::ReadAvail, ::WriteDone,
+                          (int)this);
+    console->SetPolling(FALSE);     // until somebody reads
 }
 
+SynchConsole::~SynchConsole() {
+    delete console;
+    delete readLock;
+    delete writeLock;
+    delete readAvail;
+    delete writeDone;
+}
+
+void SynchConsole::ReadAvail() { readAvail->V(); }
+void SynchConsole::WriteDone() { writeDone->V(); }
+
 void SynchConsole::PutChar(char ch) {
-    lock->Acquire();
-    console->PutChar(ch);
-    writeDone->P();
-    lock->Release();
+    Write(&ch, 1);
 }
 
+// GetChar
+//  Returns EOF at the end of the input.
 char SynchConsole::GetChar() {
-    lock->Acquire();
-    readAvail->P();
-    char ch = console->GetChar();
-    lock->Release();
+    char ch;
+    if(Read(&ch, 1) == 0)
+        return EOF;
     return ch;
 }
+
+// Read
+//  Return what is already buffered, or else poll the keyboard until a
+//  line (or part of one) comes in.  A leftover V from input that was
+//  taken without waiting just sends us round the loop once more.
+//  Returns 0 at the end of the input.
+int SynchConsole::Read(char *into, int numBytes) {
+    int n;
+
+    readLock->Acquire();
+    n = console->GetChars(into, numBytes);
+    if(n == 0 && numBytes > 0 && !console->AtEof()) {
+        console->SetPolling(TRUE);
+        while((n = console->GetChars(into, numBytes)) == 0
+              && !console->AtEof())
+            readAvail->P();
+        console->SetPolling(FALSE);
+    }
+    readLock->Release();
+    return n;
+}
+
+// Write
+//  Hand the output to the device in pieces that end at a newline (or
+//  after ConsoleLineSize chars), waiting for each to complete.
+void SynchConsole::Write(char *from, int numBytes) {
+    int done = 0;
+
+    writeLock->Acquire();
+    while(done < numBytes) {
+        int n = 0;
+        while(done + n < numBytes && n < ConsoleLineSize)
+            if(from[done + n++] == '\n')
+                break;
+        console->PutChars(from + done, n);
+        writeDone->P();
+        done += n;
+    }
+    writeLock->Release();
+}
@@ -7,6 +7,12 @@
 #include "console.h"
 
 
+// A console that blocks the caller until its I/O is done.  Output is
+// handed to the device a line at a time, and input comes back a line
+// at a time, so a whole line costs one console interrupt instead of
+// one per character.  The keyboard is only polled while somebody is
+// waiting in Read.
+
 class SynchConsole {
   public:
     SynchConsole(char *readFile, char *writeFile);
@@ -14,9 +20,21 @@ class SynchConsole {
     void PutChar(char ch);
     char GetChar();
 
+    int Read(char *into, int numBytes);	// wait for input; returns at
+					// most one line, at least 1 char
+					// (0 at end of input)
+    void Write(char *from, int numBytes);// write it all, a line per
+					// device operation
+
+    void ReadAvail();			// interrupt handlers
+    void WriteDone();
+
   private:
     Console *console;
-    Lock *lock;
+    Lock *readLock;			// one reader at a time
+    Lock *writeLock;			// one writer at a time
+    Semaphore *readAvail;		// V'd when a line comes in
+    Semaphore *writeDone;		// V'd when output is finished
 };
 
 #endif // SYNCHCONSOLE_H
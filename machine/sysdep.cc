@@ -35,6 +35,7 @@ extern "C" {
 #include <sys/file.h>
 #include <sys/un.h>
 #include <sys/mman.h>
+#include <sys/stat.h>
 #ifdef HOST_i386
 #include <unistd.h>
 #include <sys/time.h>
@@ -136,6 +137,10 @@ PollFile(int fd)
 #else
     retVal = select(32, &rfd, &wfd, &xfd, &pollTime);
 #endif
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (retVal < 0 && errno == EINTR)	// a CallOnHostTick signal
+	return FALSE;			// we'll be polled again
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     ASSERT((retVal == 0) || (retVal == 1));
     if (retVal == 0)
@@ -143,6 +148,42 @@ PollFile(int fd)
     return TRUE;
 }
 
+//----------------------------------------------------------------------
+// WaitForFile
+// 	Sleep in the host until the file or socket has characters to be
+//	read, or until the time limit runs out.  Unlike PollFile, this
+//	is meant to be called when Nachos has nothing else to do: it
+//	hands the host CPU back to UNIX for as long as it waits.
+//
+//	Returns TRUE if there is something to read.
+//
+//	"fd" -- the file descriptor to wait on
+//	"usec" -- how long to wait, in microseconds; negative to wait
+//		for as long as it takes
+//----------------------------------------------------------------------
+
+bool
+WaitForFile(int fd, int usec)
+{
+    fd_set rfd;
+    struct timeval waitTime, *limit = NULL;
+    int retVal;
+
+    if (usec >= 0) {
+	waitTime.tv_sec = usec / 1000000;
+	waitTime.tv_usec = usec % 1000000;
+	limit = &waitTime;
+    }
+    do {
+	FD_ZERO(&rfd);
+	FD_SET(fd, &rfd);
+	retVal = select(fd + 1, &rfd, NULL, NULL, limit);
+    } while (retVal < 0 && errno == EINTR);
+
+    ASSERT((retVal == 0) || (retVal == 1));
+    return (retVal == 1);
+}
+
 //----------------------------------------------------------------------
 // OpenForWrite
 // 	Open a file for writing.  Create it if it doesn't exist; truncate it 
@@ -241,6 +282,22 @@ Tell(int fd)
 #endif
 }
 
+//----------------------------------------------------------------------
+// FileNumber
+// 	Return a number that identifies the UNIX file behind "fd" (its
+//	inode), so that two opens of the same file can be told apart
+//	from opens of different files.
+//----------------------------------------------------------------------
+
+int 
+FileNumber(int fd)
+{
+    struct stat st;
+    int retVal = fstat(fd, &st);
+    ASSERT(retVal >= 0);
+    return (int) st.st_ino;
+}
+
 
 //----------------------------------------------------------------------
 // Close
@@ -416,6 +473,59 @@ Delay(int seconds)
     (void) sleep((unsigned) seconds);
 }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// HostTime
+// 	Return the wall clock time on the host, in seconds, to measure
+//	how long the simulation itself takes to run.
+//----------------------------------------------------------------------
+
+double
+HostTime()
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return tv.tv_sec + tv.tv_usec / 1000000.0;
+}
+
+//----------------------------------------------------------------------
+// CallOnHostTick
+// 	Arrange that "func" will be called, from a signal handler, every
+//	"usec" microseconds of CPU time that the host spends on Nachos --
+//	to sample what the simulator is doing.  A NULL "func" stops the
+//	calls.
+//
+//	Host system calls the signal interrupts are restarted, except
+//	select, which returns early; PollFile and WaitForFile allow for it.
+//----------------------------------------------------------------------
+
+void
+CallOnHostTick(VoidNoArgFunctionPtr func, int usec)
+{
+    struct itimerval interval;
+    struct sigaction action;
+
+    interval.it_interval.tv_sec = usec / 1000000;
+    interval.it_interval.tv_usec = usec % 1000000;
+    interval.it_value = interval.it_interval;
+
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    if (func == NULL) {			// stop the timer, then the calls
+	timerclear(&interval.it_interval);
+	timerclear(&interval.it_value);
+	setitimer(ITIMER_PROF, &interval, NULL);
+	action.sa_handler = SIG_IGN;
+	(void)sigaction(SIGPROF, &action, NULL);
+    } else {
+	action.sa_handler = (void (*)(int)) func;
+	(void)sigaction(SIGPROF, &action, NULL);
+	setitimer(ITIMER_PROF, &interval, NULL);
+    }
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 //----------------------------------------------------------------------
 // Abort
 // 	Quit and drop core.
@@ -453,11 +563,17 @@ RandomInit(unsigned seed)
 //----------------------------------------------------------------------
 // Random
 // 	Return a pseudo-random number.
+//	With -record, the number is also logged; with -replay, it comes
+//	from the log instead (see replay.h).
 //----------------------------------------------------------------------
 
 int 
 Random()
 {
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (replay != NULL)			// -record or -replay
+	return replay->Value(ReplayRandom, replay->Replaying() ? 0 : rand());
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     return rand();
 }
 
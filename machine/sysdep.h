@@ -17,6 +17,10 @@
 // If no characters in the file, return without waiting.
 extern bool PollFile(int fd);
 
+// Block until there are characters to read from the file, or until
+// "usec" microseconds have gone by (forever, if "usec" is negative).
+extern bool WaitForFile(int fd, int usec);
+
 // File operations: open/read/write/lseek/close, and check for error
 // For simulating the disk and the console devices.
 extern int OpenForWrite(char *name);
@@ -26,6 +30,7 @@ extern int ReadPartial(int fd, char *buffer, int nBytes);
 extern void WriteFile(int fd, char *buffer, int nBytes);
 extern void Lseek(int fd, int offset, int whence);
 extern int Tell(int fd);
+extern int FileNumber(int fd);
 extern void Close(int fd);
 extern bool Unlink(char *name);
 
@@ -42,6 +47,11 @@ extern void SendToSocket(int sockID, char *buffer, int packetSize,char *toName);
 extern void Abort();
 extern void Exit(int exitCode);
 extern void Delay(int seconds);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+extern double HostTime();	// seconds of wall clock time on the host
+extern void CallOnHostTick(VoidNoArgFunctionPtr func, int usec);
+				// call func every usec of host CPU time
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 // Initialize system so that cleanUp routine is called when user hits ctl-C
 extern void CallOnUserAbort(VoidNoArgFunctionPtr cleanUp);
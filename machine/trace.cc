@@ -0,0 +1,83 @@
+// trace.cc
+//	Routines to record kernel events in a binary trace file.
+//	See trace.h.
+//
+//  DO NOT CHANGE -- part of the machine emulation
+
+#include "copyright.h"
+#include "system.h"
+#include "trace.h"
+
+//----------------------------------------------------------------------
+// Trace::Trace
+// 	Create the trace file (replacing any old one), and write its
+//	header.
+//
+//	"fileName" -- UNIX file to put the trace in
+//----------------------------------------------------------------------
+
+Trace::Trace(char *fileName)
+{
+    TraceFileHeader hdr;
+
+    file = OpenForWrite(fileName);
+    buffer = new TraceRecord[TraceBufferSize];
+    used = written = 0;
+
+    hdr.magic = TraceMagic;
+    hdr.version = TraceVersion;
+    hdr.recordSize = sizeof(TraceRecord);
+    hdr.tickNanos = 1000;		// a tick is "a microsecond"; see stats.h
+    WriteFile(file, (char *) &hdr, sizeof(hdr));
+}
+
+//----------------------------------------------------------------------
+// Trace::~Trace
+// 	Write out the events still in memory, and close the file.
+//----------------------------------------------------------------------
+
+Trace::~Trace()
+{
+    Flush();
+    Close(file);
+    delete [] buffer;
+}
+
+//----------------------------------------------------------------------
+// Trace::Record
+// 	Add an event to the buffer, writing the buffer out first if it is
+//	full.  Stamped with the simulated time and the running thread.
+//
+//	"type" -- what happened
+//	"arg1", "arg2" -- the details, which depend on "type"
+//----------------------------------------------------------------------
+
+void
+Trace::Record(TraceEvent type, int arg1, int arg2)
+{
+    if (used == TraceBufferSize)
+	Flush();
+
+    TraceRecord *rec = &buffer[used++];
+    rec->time = stats->totalTicks;
+    rec->type = type;
+    rec->thread = (currentThread != NULL) ? currentThread->getThreadID() : -1;
+    rec->arg1 = arg1;
+    rec->arg2 = arg2;
+}
+
+//----------------------------------------------------------------------
+// Trace::Flush
+// 	Write the buffered events to the file, emptying the buffer.
+//	Costs host time only; simulated time doesn't move.
+//----------------------------------------------------------------------
+
+void
+Trace::Flush()
+{
+    if (used == 0)
+	return;
+    WriteFile(file, (char *) buffer, used * sizeof(TraceRecord));
+    written += used;
+    used = 0;
+}
@@ -0,0 +1,99 @@
+// trace.h
+//	Data structures for a binary trace of kernel events: context
+//	switches, threads becoming ready, interrupts, page faults and TLB
+//	misses, disk requests, and system calls.
+//
+//	Each event is one fixed-size TraceRecord, stamped with the
+//	simulated time and the running thread.  Records go into a buffer
+//	in memory, which is written out to the trace file whenever it
+//	fills up, and when Nachos halts; recording an event is just a few
+//	stores.  With tracing off (no -trace flag), each place that could
+//	record an event costs one test of a global pointer.
+//
+//	The trace file is a TraceFileHeader followed by the records, in
+//	the byte order of the host.  bin/trace2json turns it into the
+//	Chrome trace event format, for viewing in chrome://tracing or
+//	Perfetto.
+//
+//  DO NOT CHANGE -- part of the machine emulation
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "copyright.h"
+#include "utility.h"
+
+// The kinds of event.  bin/trace2json.c knows these numbers, so only
+// ever add to the end.
+
+enum TraceEvent {
+    TraceSwitch,		// context switch: from thread arg1 to arg2
+    TraceReady,			// thread arg1 put on the ready list
+    TraceInterrupt,		// interrupt of IntType arg1 fired, arg2
+				//	ticks after it was due
+    TracePageFault,		// page fault at virtual address arg1
+    TraceTlbMiss,		// TLB miss at virtual address arg1
+    TraceDiskRequest,		// disk request for sector arg1; arg2 is
+				//	1 for a write, 0 for a read
+    TraceDiskDone,		// disk request for sector arg1 done
+    TraceSyscallEnter,		// system call, code arg1
+    TraceSyscallExit,		// system call code arg1 returns arg2
+    NumTraceEvents
+};
+
+// One event, as it is kept in memory and written to the file
+
+class TraceRecord {
+  public:
+    int time;			// stats->totalTicks when it happened
+    short type;			// a TraceEvent
+    short thread;		// id of the running thread, -1 if none
+    int arg1, arg2;		// depend on the type; see above
+};
+
+#define TraceMagic	0x4352544e	// "NTRC", in the host's byte order
+#define TraceVersion	1
+#define TraceBufferSize	16384		// records kept in memory
+
+// At the front of the trace file
+
+class TraceFileHeader {
+  public:
+    int magic;			// TraceMagic
+    int version;		// TraceVersion
+    int recordSize;		// sizeof(TraceRecord)
+    int tickNanos;		// nanoseconds per tick, for display
+};
+
+// The following class defines the trace buffer and the file it goes to.
+
+class Trace {
+  public:
+    Trace(char *fileName);	// Start tracing into "fileName"
+    ~Trace();			// Write out what is left, close the file
+
+    void Record(TraceEvent type, int arg1, int arg2);
+				// Add an event; call through TRACE
+    void Flush();		// Write the buffer out to the file
+    int Count() { return written + used; }
+				// # events recorded so far
+
+  private:
+    int file;			// UNIX file descriptor of the trace file
+    TraceRecord *buffer;	// events not yet written out
+    int used;			// # records in use in buffer
+    int written;		// # records already in the file
+};
+
+extern Trace *trace;		// NULL unless tracing (-trace)
+
+// Record an event, if tracing.  A macro, so the arguments aren't even
+// evaluated when tracing is off.
+
+#define TRACE(type, arg1, arg2)						      \
+    do {								      \
+	if (trace != NULL)						      \
+	    trace->Record((type), (arg1), (arg2));			      \
+    } while (0)
+
+#endif // TRACE_H
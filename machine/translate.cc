@@ -85,7 +85,7 @@ ShortToMachine(unsigned short shortword) { return ShortToHost(shortword); }
 //----------------------------------------------------------------------
 
 bool
-Machine::ReadMem(int addr, int size, int *value)
+Machine::ReadMem(int addr, int size, int *value, bool fetching)
 {
     int data;
     ExceptionType exception;
@@ -93,7 +93,15 @@ Machine::ReadMem(int addr, int size, int *value)
 
     DEBUG('a', "Reading VA 0x%x, size %d\n", addr, size);
 
-    exception = Translate(addr, &physicalAddress, size, FALSE);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (TrackPhase) {
+	int oldPhase = phase;		// we may be in the kernel, copying
+	phase = SimTranslate;		// a system call's arguments
+	exception = Translate(addr, &physicalAddress, size, FALSE, fetching);
+	phase = oldPhase;
+    } else
+	exception = Translate(addr, &physicalAddress, size, FALSE, fetching);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     if (exception != NoException) {
 				machine->RaiseException(exception, addr);
@@ -143,7 +151,15 @@ Machine::WriteMem(int addr, int size, int value)
 
     DEBUG('a', "Writing VA 0x%x, size %d, value 0x%x\n", addr, size, value);
 
-    exception = Translate(addr, &physicalAddress, size, TRUE);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (TrackPhase) {
+	int oldPhase = phase;
+	phase = SimTranslate;
+	exception = Translate(addr, &physicalAddress, size, TRUE);
+	phase = oldPhase;
+    } else
+	exception = Translate(addr, &physicalAddress, size, TRUE);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     if (exception != NoException) {
 	machine->RaiseException(exception, addr);
 	return FALSE;
@@ -182,16 +198,33 @@ Machine::WriteMem(int addr, int size, int value)
 //	"physAddr" -- the place to store the physical address
 //	"size" -- the amount of memory being read or written
 // 	"writing" -- if TRUE, check the "read-only" bit in the TLB
+//	"fetching" -- TRUE for an instruction fetch
 //----------------------------------------------------------------------
 
 ExceptionType
-Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
+Machine::Translate(int virtAddr, int* physAddr, int size, bool writing,
+		   bool fetching)
 {
     int i;
     unsigned int vpn, offset;
     TranslationEntry *entry;
     unsigned int pageFrame;
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+// linear page table: if this is the page we translated last time for
+// this kind of access, the frame is all we need.  The entry's checks
+// were done, and its use (and for writes, dirty) bit set, when the
+// memo was filled; FlushTranslateMemo forgets it if the entry changes.
+// Alignment is checked again: size - 1 is 0, 1 or 3.
+		TranslateMemo *memo = fetching ? &fetchMemo
+						: (writing ? &writeMemo : &readMemo);
+		unsigned int inPage = (unsigned) virtAddr - (unsigned) memo->page;
+		if (inPage < memo->size && !(virtAddr & (size - 1))) {
+				*physAddr = memo->frame + inPage;
+				return NoException;
+		}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
     DEBUG('a', "\tTranslate 0x%x, %s: ", virtAddr, writing ? "write" : "read");
 
 // check for alignment errors
@@ -277,7 +310,7 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 
     // if the pageFrame is too big, there is something really wrong!
     // An invalid translation was loaded into the page table or TLB.
-    if (pageFrame >= NumPhysPages) {
+    if (pageFrame >= (unsigned) NumPhysPages) {
 	DEBUG('a', "*** frame %d > %d!\n", pageFrame, NumPhysPages);
 	return BusErrorException;
     }
@@ -286,6 +319,13 @@ Machine::Translate(int virtAddr, int* physAddr, int size, bool writing)
 	entry->dirty = TRUE;
     *physAddr = pageFrame * PageSize + offset;
     ASSERT((*physAddr >= 0) && ((*physAddr + size) <= MemorySize));
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+		if (tlb == NULL && invertedPageTable == NULL) {
+				memo->page = vpn * PageSize;
+				memo->frame = pageFrame * PageSize;
+				memo->size = PageSize;
+		}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     DEBUG('a', "phys addr = 0x%x\n", *physAddr);
     return NoException;
 }
@@ -6,6 +6,8 @@
 //	  1. Two copies of Nachos must be running, with machine ID's 0 and 1:
 //		./nachos -m 0 -o 1 &
 //		./nachos -m 1 -o 0 &
+//	     (or, for RingTest, one copy simulating the whole cluster:
+//		./nachos -cluster 64 -ring 10)
 //
 //	  2. You need an implementation of condition variables,
 //	     which is *not* provided as part of the baseline threads 
@@ -22,6 +24,7 @@
 #include "network.h"
 #include "post.h"
 #include "interrupt.h"
+#include "transport.h"
 
 // Test out message delivery, by doing the following:
 //	1. send a message to the machine with ID "farAddr", at mail box #0
@@ -70,3 +73,99 @@ MailTest(int farAddr)
     // Then we're done!
     interrupt->Halt();
 }
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+// Test out reliable delivery: open a connection to mailbox #2 on the
+// machine with ID "farAddr", send it a message far bigger than one
+// packet, and check the one it sends us.  Try it with "-l 0.9".
+
+#define ReliableTestSize 2000
+
+void
+ReliableTest(int farAddr)
+{
+    Connection *conn = new Connection(2, farAddr, 2);
+    char *out = new char[ReliableTestSize];
+    char *in = new char[ReliableTestSize];
+    int start = stats->totalTicks;
+    int i, length;
+
+    for (i = 0; i < ReliableTestSize; i++)
+	out[i] = (char) i;
+    conn->Send(out, ReliableTestSize);
+
+    length = conn->Receive(in, ReliableTestSize);
+    for (i = 0; i < ReliableTestSize && in[i] == (char) i; i++)
+	;
+    printf("Got %d bytes from %d, %s\n", length, farAddr,
+	(length == ReliableTestSize && i == ReliableTestSize) ?
+						"all correct" : "CORRUPTED");
+
+    conn->Flush();			// make sure the other side has
+					// everything before we go
+    printf("Done in %d ticks, %d segments sent again\n",
+	stats->totalTicks - start, conn->Retransmits());
+    fflush(stdout);
+
+    // Give the other side time to get our last acknowledgements.
+    // Then we're done!
+    for (i = 0; i < 10 * RetransmitTime / SystemTick; i++)
+	currentThread->Yield();
+    interrupt->Halt();
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+// Test out a cluster of machines simulated in one process (-cluster N):
+// pass a token around the ring 0 -> 1 -> ... -> N-1 -> 0, "rounds"
+// times, in mailbox #0 of each machine.  Machine 0 runs RingTest; the
+// others run RingRelay, forked by the cluster.
+
+static void
+RingSend(NetworkAddress to, int hops)
+{
+    PacketHeader outPktHdr;
+    MailHeader outMailHdr;
+
+    outPktHdr.to = to;
+    outMailHdr.to = 0;
+    outMailHdr.from = 0;
+    outMailHdr.length = sizeof(int);
+    postOffice->Send(outPktHdr, outMailHdr, (char *) &hops);
+}
+
+static int
+RingReceive()
+{
+    PacketHeader inPktHdr;
+    MailHeader inMailHdr;
+    int hops;
+
+    postOffice->Receive(0, &inPktHdr, &inMailHdr, (char *) &hops);
+    return hops;
+}
+
+static void
+RingRelay(int which)
+{
+    for (;;)
+	RingSend((which + 1) % cluster->Size(), RingReceive() + 1);
+}
+
+void
+RingTest(int rounds)
+{
+    int hops = 0;
+
+    ASSERT(cluster != NULL);		// needs -cluster
+    cluster->Fork(RingRelay);
+    for (int i = 0; i < rounds; i++) {
+	RingSend(1 % cluster->Size(), hops + 1);
+	hops = RingReceive();
+    }
+    printf("Token went round %d machines %d times: %d hops in %d ticks\n",
+		cluster->Size(), rounds, hops, stats->totalTicks);
+    fflush(stdout);
+    interrupt->Halt();
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
@@ -21,25 +21,6 @@
 #ifdef HOST_SPARC
 #include <strings.h>
 #endif
-//----------------------------------------------------------------------
-// Mail::Mail
-//      Initialize a single mail message, by concatenating the headers to
-//	the data.
-//
-//	"pktH" -- source, destination machine ID's
-//	"mailH" -- source, destination mailbox ID's
-//	"data" -- payload data
-//----------------------------------------------------------------------
-
-Mail::Mail(PacketHeader pktH, MailHeader mailH, char *msgData)
-{
-    ASSERT(mailH.length <= MaxMailSize);
-
-    pktHdr = pktH;
-    mailHdr = mailH;
-    bcopy(msgData, data, mailHdr.length);
-}
-
 //----------------------------------------------------------------------
 // MailBox::MailBox
 //      Initialize a single mail box within the post office, so that it
@@ -88,24 +69,51 @@ PrintHeader(PacketHeader pktHdr, MailHeader mailHdr)
 // 	Add a message to the mailbox.  If anyone is waiting for message
 //	arrival, wake them up!
 //
-//	We need to reconstruct the Mail message (by concatenating the headers
-//	to the data), to simplify queueing the message on the SynchList.
+//	The message stays in the buffer it arrived in (or the copy the
+//	post office made of it); we just queue the buffer on the SynchList.
 //
-//	"pktHdr" -- source, destination machine ID's
-//	"mailHdr" -- source, destination mailbox ID's
-//	"data" -- payload message data
+//	"buffer" -- the packet, headers and data
 //----------------------------------------------------------------------
 
 void 
-MailBox::Put(PacketHeader pktHdr, MailHeader mailHdr, char *data)
+MailBox::Put(PacketBuffer *buffer)
 { 
-    Mail *mail = new Mail(pktHdr, mailHdr, data); 
-
-    messages->Append((void *)mail);	// put on the end of the list of 
+    messages->Append((void *)buffer);	// put on the end of the list of 
 					// arrived messages, and wake up 
 					// any waiters
 }
 
+//----------------------------------------------------------------------
+// MailBox::Lend
+// 	Get a message from a mailbox, parsing it into the packet header,
+//	mailbox header, and a pointer to the data, which is left where it
+//	is.  The caller gets our reference to the buffer holding it.
+//
+//	The calling thread waits if there are no messages in the mailbox.
+//
+//	"pktHdr" -- address to put: source, destination machine ID's
+//	"mailHdr" -- address to put: source, destination mailbox ID's
+//	"data" -- address to put: where the payload message data is
+//----------------------------------------------------------------------
+
+PacketBuffer *
+MailBox::Lend(PacketHeader *pktHdr, MailHeader *mailHdr, char **data)
+{
+    DEBUG('n', "Waiting for mail in mailbox\n");
+    PacketBuffer *buffer = (PacketBuffer *) messages->Remove();
+					// remove message from list;
+					// will wait if list is empty
+
+    *pktHdr = *buffer->Header();
+    *mailHdr = *(MailHeader *) buffer->Data();
+    *data = buffer->Data() + sizeof(MailHeader);
+    if (DebugIsEnabled('n')) {
+	printf("Got mail from mailbox: ");
+	PrintHeader(*pktHdr, *mailHdr);
+    }
+    return buffer;
+}
+
 //----------------------------------------------------------------------
 // MailBox::Get
 // 	Get a message from a mailbox, parsing it into the packet header,
@@ -121,21 +129,15 @@ MailBox::Put(PacketHeader pktHdr, MailHeader mailHdr, char *data)
 void 
 MailBox::Get(PacketHeader *pktHdr, MailHeader *mailHdr, char *data) 
 { 
-    DEBUG('n', "Waiting for mail in mailbox\n");
-    Mail *mail = (Mail *) messages->Remove();	// remove message from list;
-						// will wait if list is empty
+    char *msgData;
+    PacketBuffer *buffer = Lend(pktHdr, mailHdr, &msgData);
 
-    *pktHdr = mail->pktHdr;
-    *mailHdr = mail->mailHdr;
-    if (DebugIsEnabled('n')) {
-	printf("Got mail from mailbox: ");
-	PrintHeader(*pktHdr, *mailHdr);
-    }
-    bcopy(mail->data, data, mail->mailHdr.length);
+    bcopy(msgData, data, mailHdr->length);
 					// copy the message data into
-					// the caller's buffer
-    delete mail;			// we've copied out the stuff we
-					// need, we can now discard the message
+					// the caller's buffer -- the only
+					// copy made since it arrived
+    buffer->Release();			// we've copied out the stuff we
+					// need, the buffer can be reused
 }
 
 //----------------------------------------------------------------------
@@ -171,13 +173,16 @@ static void WriteDone(int arg)
 //	  drops any packets; reliability = 0 means the network never
 //	  delivers any packets)
 //	"nBoxes" is the number of mail boxes in this Post Office
+//	"queueDepth" is how many packets the network can queue for sending
+//	"linkConfig" is the file describing the network's links, or NULL
 //----------------------------------------------------------------------
 
-PostOffice::PostOffice(NetworkAddress addr, double reliability, int nBoxes)
+PostOffice::PostOffice(NetworkAddress addr, double reliability, int nBoxes,
+	int queueDepth, char *linkConfig)
 {
 // First, initialize the synchronization with the interrupt handlers
     messageAvailable = new Semaphore("message available", 0);
-    messageSent = new Semaphore("message sent", 0);
+    queueSlots = new Semaphore("transmit queue slots", queueDepth);
     sendLock = new Lock("message send lock");
 
 // Second, initialize the mailboxes
@@ -186,7 +191,8 @@ PostOffice::PostOffice(NetworkAddress addr, double reliability, int nBoxes)
     boxes = new MailBox[nBoxes];
 
 // Third, initialize the network; tell it which interrupt handlers to call
-    network = new Network(addr, reliability, ReadAvail, WriteDone, (int) this);
+    network = new Network(addr, reliability, ReadAvail, WriteDone, (int) this,
+			  queueDepth, linkConfig);
 
 
 // Finally, create a thread whose sole job is to wait for incoming messages,
@@ -206,7 +212,7 @@ PostOffice::~PostOffice()
     delete network;
     delete [] boxes;
     delete messageAvailable;
-    delete messageSent;
+    delete queueSlots;
     delete sendLock;
 }
 
@@ -214,34 +220,46 @@ PostOffice::~PostOffice()
 // PostOffice::PostalDelivery
 // 	Wait for incoming messages, and put them in the right mailbox.
 //
-//      Incoming messages have had the PacketHeader stripped off,
-//	but the MailHeader is still tacked on the front of the data.
+//      Incoming messages are left in the network's buffers, with the
+//	PacketHeader and then the MailHeader on the front of the data --
+//	unless the pool of buffers is running low, whoever the mail
+//	is for, in which case we copy it out and free the buffer.
 //----------------------------------------------------------------------
 
 void
 PostOffice::PostalDelivery()
 {
-    PacketHeader pktHdr;
-    MailHeader mailHdr;
-    char *buffer = new char[MaxPacketSize];
+    PacketBuffer *buffer;
+    MailHeader *mailHdr;
 
     for (;;) {
         // first, wait for a message
         messageAvailable->P();	
-        pktHdr = network->Receive(buffer);
+        buffer = network->ReceiveBuffer();
+	ASSERT(buffer != NULL);
 
-        mailHdr = *(MailHeader *)buffer;
+        mailHdr = (MailHeader *)buffer->Data();
         if (DebugIsEnabled('n')) {
 	    printf("Putting mail into mailbox: ");
-	    PrintHeader(pktHdr, mailHdr);
+	    PrintHeader(*buffer->Header(), *mailHdr);
         }
 
 	// check that arriving message is legal!
-	ASSERT(0 <= mailHdr.to && mailHdr.to < numBoxes);
-	ASSERT(mailHdr.length <= MaxMailSize);
+	ASSERT(0 <= mailHdr->to && mailHdr->to < numBoxes);
+	ASSERT(mailHdr->length <= MaxMailSize);
 
-	// put into mailbox
-        boxes[mailHdr.to].Put(pktHdr, mailHdr, buffer + sizeof(MailHeader));
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+	if (network->NumFreeBuffers() < PostOfficeReserve) {
+	    PacketBuffer *copy = buffer->Copy();
+
+	    buffer->Release();		// back to the pool, for other mail
+	    buffer = copy;
+	    mailHdr = (MailHeader *)buffer->Data();
+	}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+	// put into mailbox, buffer and all
+        boxes[mailHdr->to].Put(buffer);
     }
 }
 
@@ -253,6 +271,9 @@ PostOffice::PostalDelivery()
 //	Note that the MailHeader + data looks just like normal payload
 //	data to the Network.
 //
+//	The network queues the packet and sends it when its turn comes,
+//	so we only have to wait if the queue is full.
+//
 //	"pktHdr" -- source, destination machine ID's
 //	"mailHdr" -- source, destination mailbox ID's
 //	"data" -- payload message data
@@ -261,9 +282,42 @@ PostOffice::PostalDelivery()
 void
 PostOffice::Send(PacketHeader pktHdr, MailHeader mailHdr, char* data)
 {
-    char* buffer = new char[MaxPacketSize];	// space to hold concatenated
-						// mailHdr + data
+    sendLock->Acquire();
+    QueueMessage(pktHdr, mailHdr, data);
+    sendLock->Release();
+}
+
+//----------------------------------------------------------------------
+// PostOffice::SendMany
+// 	Send a batch of messages.  They are handed to the network one
+//	after the other, with no other thread's messages in between,
+//	for the price of one trip through the send lock.
+//
+//	"count" -- how many messages
+//	"pktHdrs", "mailHdrs", "data" -- arrays of "count" entries, one
+//		per message, as for Send
+//----------------------------------------------------------------------
+
+void
+PostOffice::SendMany(int count, PacketHeader *pktHdrs, MailHeader *mailHdrs,
+								char **data)
+{
+    sendLock->Acquire();
+    for (int i = 0; i < count; i++)
+	QueueMessage(pktHdrs[i], mailHdrs[i], data[i]);
+    sendLock->Release();
+}
 
+//----------------------------------------------------------------------
+// PostOffice::QueueMessage
+// 	Fill in the packet header and put one message in the network's
+//	transmit queue, waiting for room if necessary.  The caller holds
+//	the send lock.
+//----------------------------------------------------------------------
+
+void
+PostOffice::QueueMessage(PacketHeader pktHdr, MailHeader mailHdr, char* data)
+{
     if (DebugIsEnabled('n')) {
 	printf("Post send: ");
 	PrintHeader(pktHdr, mailHdr);
@@ -275,19 +329,11 @@ PostOffice::Send(PacketHeader pktHdr, MailHeader mailHdr, char* data)
     pktHdr.from = netAddr;
     pktHdr.length = mailHdr.length + sizeof(MailHeader);
 
-    // concatenate MailHeader and data
-    bcopy(&mailHdr, buffer, sizeof(MailHeader));
-    bcopy(data, buffer + sizeof(MailHeader), mailHdr.length);
-
-    sendLock->Acquire();   		// only one message can be sent
-					// to the network at any one time
-    network->Send(pktHdr, buffer);
-    messageSent->P();			// wait for interrupt to tell us
-					// ok to send the next message
-    sendLock->Release();
-
-    delete [] buffer;			// we've sent the message, so
-					// we can delete our buffer
+    queueSlots->P();			// wait for room in the network's
+					// transmit queue
+    network->Send(pktHdr, (char *) &mailHdr, sizeof(MailHeader), data);
+					// the network puts the MailHeader
+					// and data together as it queues it
 }
 
 //----------------------------------------------------------------------
@@ -315,6 +361,28 @@ PostOffice::Receive(int box, PacketHeader *pktHdr,
     ASSERT(mailHdr->length <= MaxMailSize);
 }
 
+//----------------------------------------------------------------------
+// PostOffice::Lend
+// 	Retrieve a message from a specific box like Receive, but lend
+//	the caller the buffer it arrived in rather than copying it out.
+//	The caller must Release the buffer returned once it is done with
+//	the data.
+//
+//	"box" -- mailbox ID in which to look for message
+//	"pktHdr" -- address to put: source, destination machine ID's
+//	"mailHdr" -- address to put: source, destination mailbox ID's
+//	"data" -- address to put: where the payload message data is
+//----------------------------------------------------------------------
+
+PacketBuffer *
+PostOffice::Lend(int box, PacketHeader *pktHdr, MailHeader *mailHdr,
+								char **data)
+{
+    ASSERT((box >= 0) && (box < numBoxes));
+
+    return boxes[box].Lend(pktHdr, mailHdr, data);
+}
+
 //----------------------------------------------------------------------
 // PostOffice::IncomingPacket
 // 	Interrupt handler, called when a packet arrives from the network.
@@ -330,8 +398,8 @@ PostOffice::IncomingPacket()
 
 //----------------------------------------------------------------------
 // PostOffice::PacketSent
-// 	Interrupt handler, called when the next packet can be put onto the 
-//	network.
+// 	Interrupt handler, called when a packet has left the network's
+//	transmit queue, so another can be put in.
 //
 //	The name of this routine is a misnomer; if "reliability < 1",
 //	the packet could have been dropped by the network, so it won't get
@@ -341,6 +409,6 @@ PostOffice::IncomingPacket()
 void 
 PostOffice::PacketSent()
 { 
-    messageSent->V();
+    queueSlots->V();
 }
 
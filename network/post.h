@@ -53,22 +53,21 @@ class MailHeader {
 #define MaxMailSize 	(MaxPacketSize - sizeof(MailHeader))
 
 
-// The following class defines the format of an incoming/outgoing 
-// "Mail" message.  The message format is layered: 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+// An incoming message is kept in the PacketBuffer it arrived in, which
+// is layered:
 //	network header (PacketHeader) 
 //	post office header (MailHeader) 
 //	data
+// so it is not copied until a thread receives it.  But the buffers come
+// from the network's small fixed pool, and mail nobody reads must not
+// use it all up, or no other mail could come in.  So once fewer than
+// PostOfficeReserve buffers are left in the pool, the post office
+// copies each message out of its buffer before putting it in a
+// mailbox, and the buffer goes straight back.
 
-class Mail {
-  public:
-     Mail(PacketHeader pktH, MailHeader mailH, char *msgData);
-				// Initialize a mail message by
-				// concatenating the headers to the data
-
-     PacketHeader pktHdr;	// Header appended by Network
-     MailHeader mailHdr;	// Header appended by PostOffice
-     char data[MaxMailSize];	// Payload -- message data
-};
+#define PostOfficeReserve (NetworkRxBuffers / 4)
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 // The following class defines a single mailbox, or temporary storage
 // for messages.   Incoming messages are put by the PostOffice into the 
@@ -80,12 +79,21 @@ class MailBox {
     MailBox();			// Allocate and initialize mail box
     ~MailBox();			// De-allocate mail box
 
-    void Put(PacketHeader pktHdr, MailHeader mailHdr, char *data);
-   				// Atomically put a message into the mailbox
+    void Put(PacketBuffer *buffer);
+   				// Atomically put a message into the mailbox;
+				// the mailbox takes over the caller's
+				// reference to the buffer
     void Get(PacketHeader *pktHdr, MailHeader *mailHdr, char *data); 
    				// Atomically get a message out of the 
 				// mailbox (and wait if there is no message 
 				// to get!)
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    PacketBuffer *Lend(PacketHeader *pktHdr, MailHeader *mailHdr,
+	char **data);		// Like Get, but instead of copying the
+				// data, point "data" at it, in the buffer
+				// it arrived in.  The caller must Release
+				// the buffer returned when done.
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
   private:
     SynchList *messages;	// A mailbox is just a list of arrived messages
 };
@@ -101,28 +109,45 @@ class MailBox {
 
 class PostOffice {
   public:
-    PostOffice(NetworkAddress addr, double reliability, int nBoxes);
+    PostOffice(NetworkAddress addr, double reliability, int nBoxes,
+		int queueDepth = NetworkTxQueue, char *linkConfig = NULL);
 				// Allocate and initialize Post Office
 				//   "reliability" is how many packets
-				//   get dropped by the underlying network
+				//   get dropped by the underlying network;
+				//   "queueDepth" is how many can wait in
+				//   the network's transmit queue;
+				//   "linkConfig" is passed on to the
+				//   network, to model its links
     ~PostOffice();		// De-allocate Post Office data
     
     void Send(PacketHeader pktHdr, MailHeader mailHdr, char *data);
     				// Send a message to a mailbox on a remote 
 				// machine.  The fromBox in the MailHeader is 
-				// the return box for ack's.
+				// the return box for ack's.  Waits only if
+				// the network's transmit queue is full.
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    void SendMany(int count, PacketHeader *pktHdrs, MailHeader *mailHdrs,
+		char **data);	// Send "count" messages, back to back,
+				// taking the send lock only once
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     
     void Receive(int box, PacketHeader *pktHdr, 
 		MailHeader *mailHdr, char *data);
     				// Retrieve a message from "box".  Wait if
 				// there is no message in the box.
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    PacketBuffer *Lend(int box, PacketHeader *pktHdr,
+		MailHeader *mailHdr, char **data);
+				// Retrieve a message from "box" without
+				// copying it; see MailBox::Lend
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     void PostalDelivery();	// Wait for incoming messages, 
 				// and then put them in the correct mailbox
 
     void PacketSent();		// Interrupt handler, called when outgoing 
-				// packet has been put on network; next 
-				// packet can now be sent
+				// packet has been put on network; there
+				// is room in the queue for another
     void IncomingPacket();	// Interrupt handler, called when incoming
    				// packet has arrived and can be pulled
 				// off of network (i.e., time to call 
@@ -134,8 +159,13 @@ class PostOffice {
     MailBox *boxes;		// Table of mail boxes to hold incoming mail
     int numBoxes;		// Number of mail boxes
     Semaphore *messageAvailable;// V'ed when message has arrived from network
-    Semaphore *messageSent;	// V'ed when next message can be sent to network
-    Lock *sendLock;		// Only one outgoing message at a time
+    Semaphore *queueSlots;	// # free places in the network's transmit
+				// queue; V'ed as each packet goes out
+    Lock *sendLock;		// Only one sender queueing at a time, so
+				// a batch goes out together
+
+    void QueueMessage(PacketHeader pktHdr, MailHeader mailHdr, char *data);
+				// Hand one message to the network
 };
 
 #endif
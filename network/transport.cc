@@ -0,0 +1,355 @@
+// transport.cc
+//	Routines for reliable, ordered message delivery on top of the
+//	Post Office.  See transport.h.
+//
+//	Each Connection has two threads of its own, besides the threads
+//	that call Send and Receive:
+//	  the receiver, which takes every piece of mail out of the local
+//	    mailbox, and either moves the send window forward (for an
+//	    acknowledgement) or queues the segment for Receive (for data);
+//	  the retransmitter, which sleeps until the retransmission timer
+//	    runs out, and then sends every unacknowledged segment again.
+//
+//	The timer is an interrupt, scheduled with Interrupt::Schedule.
+//	Interrupts can't be cancelled, so the timer keeps its deadline
+//	in the Connection, and a timer interrupt that finds the deadline
+//	moved later simply schedules itself again.
+
+#include "copyright.h"
+#include "system.h"
+#include "transport.h"
+
+//----------------------------------------------------------------------
+// TransportReceiver, TransportRetransmitter, TransportTimer
+// 	Dummy functions because C++ can't indirectly invoke member
+//	functions.  The first two are forked as the Connection's
+//	threads; the last is the retransmission timer's interrupt handler.
+//
+//	"arg" -- pointer to the Connection
+//----------------------------------------------------------------------
+
+static void TransportReceiver(int arg)
+{ Connection *c = (Connection *) arg; c->ReceiveSegments(); }
+static void TransportRetransmitter(int arg)
+{ Connection *c = (Connection *) arg; c->Retransmitter(); }
+static void TransportTimer(int arg)
+{ Connection *c = (Connection *) arg; c->RetransmitTimer(); }
+
+//----------------------------------------------------------------------
+// Connection::Connection
+// 	Set up one end of a connection, and start its threads.
+//
+//	"localBox" -- the mailbox on this machine that the other end
+//		sends to; the connection takes it over
+//	"remoteAddr", "remoteBox" -- where the other end is
+//----------------------------------------------------------------------
+
+Connection::Connection(MailBoxAddress local, NetworkAddress addr,
+	MailBoxAddress box)
+{
+    localBox = local;
+    remoteAddr = addr;
+    remoteBox = box;
+
+    lock = new Lock("connection lock");
+    sendLock = new Lock("connection send lock");
+    receiveLock = new Lock("connection receive lock");
+
+    sendBase = sendNext = 0;
+    windowOpen = new Condition("send window open");
+    timerOn = timerScheduled = FALSE;
+    timerDeadline = 0;
+    timedOut = new Semaphore("retransmit time out", 0);
+    retransmits = 0;
+
+    for (int i = 0; i < TransportWindow; i++)
+	receiveWindow[i] = NULL;
+    receiveNext = 0;
+    delivered = new List;
+    segmentArrived = new Condition("segment arrived");
+
+    Thread *t = new Thread("transport receiver");
+    t->Fork(TransportReceiver, (int) this);
+    t = new Thread("transport retransmitter");
+    t->Fork(TransportRetransmitter, (int) this);
+}
+
+//----------------------------------------------------------------------
+// Connection::Send
+// 	Cut a message into segments and send them, waiting whenever
+//	TransportWindow segments are already unacknowledged.
+//
+//	"data" -- the message
+//	"length" -- how many bytes of it; may be 0
+//----------------------------------------------------------------------
+
+void
+Connection::Send(char *data, int length)
+{
+    int done = 0;
+    Segment seg;
+
+    sendLock->Acquire();
+    do {
+	lock->Acquire();
+	while (sendNext - sendBase == TransportWindow)
+	    windowOpen->Wait(lock);
+
+	Segment *slot = &sendWindow[sendNext % TransportWindow];
+	slot->length = min(length - done, (int) MaxSegmentSize);
+	slot->hdr.seq = sendNext++;
+	slot->hdr.flags = SegData;
+	bcopy(data + done, slot->data, slot->length);
+	done += slot->length;
+	if (done == length)
+	    slot->hdr.flags |= SegEnd;
+	if (!timerOn)
+	    StartTimer();
+	seg = *slot;			// the window slot may be reused once
+	lock->Release();		// it is acknowledged
+
+	Transmit(&seg);
+    } while (done < length);
+    sendLock->Release();
+}
+
+//----------------------------------------------------------------------
+// Connection::Receive
+// 	Wait for the segments of the next message, and put them back
+//	together.
+//
+//	"data" -- where to put the message
+//	"maxLength" -- how much room there is at "data"
+//----------------------------------------------------------------------
+
+int
+Connection::Receive(char *data, int maxLength)
+{
+    int length = 0;
+    bool end = FALSE;
+
+    receiveLock->Acquire();
+    lock->Acquire();
+    while (!end) {
+	while (delivered->IsEmpty())
+	    segmentArrived->Wait(lock);
+	Segment *seg = (Segment *) delivered->Remove();
+
+	int n = min(seg->length, maxLength - length);
+	if (n > 0)
+	    bcopy(seg->data, data + length, n);
+	length += seg->length;
+	end = (seg->hdr.flags & SegEnd) != 0;
+	delete seg;
+    }
+    lock->Release();
+    receiveLock->Release();
+    return min(length, maxLength);
+}
+
+//----------------------------------------------------------------------
+// Connection::Flush
+// 	Wait until the other end has acknowledged every segment sent.
+//----------------------------------------------------------------------
+
+void
+Connection::Flush()
+{
+    lock->Acquire();
+    while (sendBase != sendNext)
+	windowOpen->Wait(lock);
+    lock->Release();
+}
+
+//----------------------------------------------------------------------
+// Connection::ReceiveSegments
+// 	Loop forever, taking mail out of the local mailbox.
+//
+//	An acknowledgement slides the send window forward, waking up
+//	Send, and restarts the timer if anything is still outstanding.
+//
+//	A data segment is kept if it falls in the receive window and we
+//	don't have it yet; then every segment now in order is passed on
+//	to Receive.  Whatever it was, we answer with an acknowledgement
+//	of everything we have in order, so a lost acknowledgement is made
+//	up for by the next one.
+//----------------------------------------------------------------------
+
+void
+Connection::ReceiveSegments()
+{
+    PacketHeader pktHdr;
+    MailHeader mailHdr;
+    char *data;
+
+    for (;;) {
+	PacketBuffer *buffer = postOffice->Lend(localBox, &pktHdr, &mailHdr,
+								&data);
+	SegmentHeader hdr = *(SegmentHeader *) data;
+	int ack = -1;
+
+	lock->Acquire();
+	if (hdr.flags & SegAck) {
+	    if (hdr.seq > sendBase && hdr.seq <= sendNext) {
+		DEBUG('n', "Connection %d: ack %d\n", localBox, hdr.seq);
+		sendBase = hdr.seq;
+		if (sendBase == sendNext)
+		    timerOn = FALSE;
+		else
+		    StartTimer();
+		windowOpen->Broadcast(lock);
+	    }
+	} else {
+	    int offset = hdr.seq - receiveNext;
+
+	    if (offset >= 0 && offset < TransportWindow
+			&& receiveWindow[hdr.seq % TransportWindow] == NULL) {
+		Segment *seg = new Segment;
+		seg->hdr = hdr;
+		seg->length = mailHdr.length - sizeof(SegmentHeader);
+		bcopy(data + sizeof(SegmentHeader), seg->data, seg->length);
+		receiveWindow[hdr.seq % TransportWindow] = seg;
+	    }
+	    while (receiveWindow[receiveNext % TransportWindow] != NULL) {
+		delivered->Append(receiveWindow[receiveNext % TransportWindow]);
+		receiveWindow[receiveNext % TransportWindow] = NULL;
+		receiveNext++;
+		segmentArrived->Broadcast(lock);
+	    }
+	    ack = receiveNext;
+	}
+	lock->Release();
+	buffer->Release();
+
+	if (ack >= 0)
+	    SendAck(ack);
+    }
+}
+
+//----------------------------------------------------------------------
+// Connection::Retransmitter
+// 	Loop forever, waiting for the retransmission timer to run out,
+//	then sending all the unacknowledged segments again.
+//----------------------------------------------------------------------
+
+void
+Connection::Retransmitter()
+{
+    Segment resend[TransportWindow];
+    PacketHeader pktHdrs[TransportWindow];
+    MailHeader mailHdrs[TransportWindow];
+    char *data[TransportWindow];
+
+    for (;;) {
+	timedOut->P();
+
+	lock->Acquire();
+	int n = sendNext - sendBase;
+	for (int i = 0; i < n; i++)
+	    resend[i] = sendWindow[(sendBase + i) % TransportWindow];
+	if (n > 0)
+	    StartTimer();
+	retransmits += n;
+	lock->Release();
+
+	DEBUG('n', "Connection %d: time out, resending %d segments\n",
+						localBox, n);
+	for (int i = 0; i < n; i++) {
+	    Address(&resend[i], &pktHdrs[i], &mailHdrs[i]);
+	    data[i] = (char *) &resend[i];
+	}
+	postOffice->SendMany(n, pktHdrs, mailHdrs, data);
+					// the whole window goes out together
+    }
+}
+
+//----------------------------------------------------------------------
+// Connection::StartTimer
+// 	Give the oldest unacknowledged segment RetransmitTime from now
+//	to be acknowledged.  Schedules a timer interrupt unless one is
+//	already on the way; that one will see the new deadline.
+//----------------------------------------------------------------------
+
+void
+Connection::StartTimer()
+{
+    IntStatus oldLevel = interrupt->SetLevel(IntOff);
+
+    timerOn = TRUE;
+    timerDeadline = stats->totalTicks + RetransmitTime;
+    if (!timerScheduled) {
+	interrupt->Schedule(TransportTimer, (int) this, RetransmitTime,
+							RetransmitInt);
+	timerScheduled = TRUE;
+    }
+    (void) interrupt->SetLevel(oldLevel);
+}
+
+//----------------------------------------------------------------------
+// Connection::RetransmitTimer
+// 	Interrupt handler for the retransmission timer.  If the timer was
+//	stopped meanwhile, do nothing; if it was restarted, wait some
+//	more; otherwise wake up the retransmitter.
+//----------------------------------------------------------------------
+
+void
+Connection::RetransmitTimer()
+{
+    timerScheduled = FALSE;
+    if (!timerOn)
+	return;
+    if (stats->totalTicks < timerDeadline) {
+	interrupt->Schedule(TransportTimer, (int) this,
+			timerDeadline - stats->totalTicks, RetransmitInt);
+	timerScheduled = TRUE;
+	return;
+    }
+    timerOn = FALSE;
+    timedOut->V();
+}
+
+//----------------------------------------------------------------------
+// Connection::Address
+// 	Fill in the headers for mailing a data segment to the other end.
+//----------------------------------------------------------------------
+
+void
+Connection::Address(Segment *seg, PacketHeader *pktHdr, MailHeader *mailHdr)
+{
+    pktHdr->to = remoteAddr;
+    mailHdr->to = remoteBox;
+    mailHdr->from = localBox;
+    mailHdr->length = sizeof(SegmentHeader) + seg->length;
+}
+
+//----------------------------------------------------------------------
+// Connection::Transmit, Connection::SendAck
+// 	Put a data segment or an acknowledgement in the mail to the
+//	other end.
+//----------------------------------------------------------------------
+
+void
+Connection::Transmit(Segment *seg)
+{
+    PacketHeader pktHdr;
+    MailHeader mailHdr;
+
+    Address(seg, &pktHdr, &mailHdr);
+    postOffice->Send(pktHdr, mailHdr, (char *) seg);
+}
+
+void
+Connection::SendAck(int seq)
+{
+    PacketHeader pktHdr;
+    MailHeader mailHdr;
+    SegmentHeader hdr;
+
+    pktHdr.to = remoteAddr;
+    mailHdr.to = remoteBox;
+    mailHdr.from = localBox;
+    mailHdr.length = sizeof(SegmentHeader);
+    hdr.seq = seq;
+    hdr.flags = SegAck;
+    postOffice->Send(pktHdr, mailHdr, (char *) &hdr);
+}
@@ -0,0 +1,128 @@
+// transport.h
+//	Data structures for reliable, ordered message delivery between
+//	two mailboxes on different machines, built on top of the
+//	(unreliable) Post Office.
+//
+//	A Connection joins a mailbox on this machine to a mailbox on
+//	another machine; the other machine makes a Connection going the
+//	opposite way.  Messages of any length are cut into segments
+//	that fit in one piece of mail.  Each segment carries a sequence
+//	number, and the receiver answers with cumulative acknowledgements
+//	("I have everything before segment n").  Up to TransportWindow
+//	segments can be unacknowledged at once, so the link stays busy
+//	instead of carrying one packet per round trip.  If the oldest
+//	unacknowledged segment goes unanswered for RetransmitTime, all
+//	of the unacknowledged segments are sent again (go-back-N).
+//
+//	The connection owns its local mailbox: nothing else should send
+//	to it or receive from it.
+
+#ifndef TRANSPORT_H
+#define TRANSPORT_H
+
+#include "copyright.h"
+#include "post.h"
+#include "synch.h"
+#include "list.h"
+
+#define TransportWindow	8	// most segments in flight at once
+#define RetransmitTime	(20 * NetworkTime)
+				// how long to wait for an acknowledgement
+
+// Kinds of segment, and marks on them
+#define SegData		1	// carries message data
+#define SegAck		2	// acknowledges everything before "seq"
+#define SegEnd		4	// last segment of a message
+
+// The following class defines the transport header, which goes at the
+// front of the mail data.
+
+class SegmentHeader {
+  public:
+    int seq;			// SegData: the segment's sequence number;
+				// SegAck: the next sequence number expected
+    int flags;			// SegData or SegAck, maybe with SegEnd
+};
+
+#define MaxSegmentSize	(MaxMailSize - sizeof(SegmentHeader))
+				// message data in one segment
+
+// A segment waiting to be acknowledged or to be delivered.  The header
+// and data are laid out just as they go in the mail, so a segment can
+// be sent without pasting them together first.
+
+class Segment {
+  public:
+    SegmentHeader hdr;
+    char data[MaxSegmentSize];
+    int length;			// bytes of data
+};
+
+// The following class defines one end of a reliable connection.
+
+class Connection {
+  public:
+    Connection(MailBoxAddress localBox, NetworkAddress remoteAddr,
+	MailBoxAddress remoteBox);
+				// Connect mailbox "localBox" here with
+				// mailbox "remoteBox" on machine
+				// "remoteAddr".  Forks the threads that
+				// deliver and retransmit segments; they run
+				// as long as the machine does, so a
+				// Connection is never deleted.
+
+    void Send(char *data, int length);
+				// Send a message of "length" bytes.
+				// Returns once all of it has been handed
+				// to the network, which may be before it
+				// has all been acknowledged.
+    int Receive(char *data, int maxLength);
+				// Wait for the next message, and copy it
+				// into "data".  Returns its length; any
+				// bytes beyond "maxLength" are lost.
+    void Flush();		// Wait until everything sent so far has
+				// been acknowledged
+    int Retransmits() { return retransmits; }
+				// # segments that had to be sent again
+
+    void ReceiveSegments();	// Internal: take segments and acks out of
+				// the local mailbox
+    void Retransmitter();	// Internal: resend on a time out
+    void RetransmitTimer();	// Internal: retransmit interrupt handler
+
+  private:
+    MailBoxAddress localBox;
+    NetworkAddress remoteAddr;
+    MailBoxAddress remoteBox;
+
+    Lock *lock;			// protects everything below
+    Lock *sendLock;		// one message being sent at a time
+    Lock *receiveLock;		// one message being received at a time
+
+    // sending side
+    Segment sendWindow[TransportWindow];
+				// unacknowledged segments, by seq number
+    int sendBase;		// oldest unacknowledged segment
+    int sendNext;		// next sequence number to use
+    Condition *windowOpen;	// signalled when segments are acknowledged
+    bool timerOn;		// are we waiting for an acknowledgement?
+    int timerDeadline;		// when to give up waiting
+    bool timerScheduled;	// is a RetransmitTimer interrupt pending?
+    Semaphore *timedOut;	// V'ed by the timer to wake Retransmitter
+    int retransmits;		// # segments sent again
+
+    // receiving side
+    Segment *receiveWindow[TransportWindow];
+				// segments that arrived out of order
+    int receiveNext;		// next sequence number to deliver
+    List *delivered;		// in-order segments, not yet Received
+    Condition *segmentArrived;	// signalled when delivered grows
+
+    void StartTimer();		// (re)start the retransmission timer
+    void Address(Segment *seg, PacketHeader *pktHdr, MailHeader *mailHdr);
+				// headers for mailing "seg"
+    void Transmit(Segment *seg);// hand a segment to the post office
+    void SendAck(int seq);	// acknowledge everything before "seq"
+};
+
+#endif // TRANSPORT_H
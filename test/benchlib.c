@@ -0,0 +1,71 @@
+/* benchlib.c
+ *	Routines shared by the benchmark programs.  See benchlib.h.
+ */
+
+#include "benchlib.h"
+
+void
+PrintString(char *s)
+{
+    int len = 0;
+
+    while (s[len] != '\0')
+	len++;
+    Write(s, len, ConsoleOutput);
+}
+
+void
+PrintInt(int n)
+{
+    char buf[12];
+    int i = 11;
+
+    buf[i] = '\0';
+    if (n == 0)
+	buf[--i] = '0';
+    else if (n < 0) {
+	PrintString("-");
+	n = -n;
+    }
+    while (n > 0) {
+	buf[--i] = '0' + n % 10;
+	n /= 10;
+    }
+    PrintString(&buf[i]);
+}
+
+static void
+PrintField(char *key, int value)
+{
+    PrintString(" ");
+    PrintString(key);
+    PrintString("=");
+    PrintInt(value);
+}
+
+void
+BenchStart(Usage *start)
+{
+    GetUsage(UsageProgram, start);
+}
+
+void
+BenchReport(char *name, char *param, int value, int ops, Usage *start)
+{
+    Usage end;
+
+    GetUsage(UsageProgram, &end);	/* before we print anything */
+
+    PrintString("BENCH name=");
+    PrintString(name);
+    if (param != 0)
+	PrintField(param, value);
+    PrintField("ops", ops);
+    PrintField("user_ticks", end.userTicks - start->userTicks);
+    PrintField("system_ticks", end.systemTicks - start->systemTicks);
+    PrintField("page_faults", end.pageFaults - start->pageFaults);
+    PrintField("tlb_misses", end.tlbMisses - start->tlbMisses);
+    PrintField("sectors_read", end.sectorsRead - start->sectorsRead);
+    PrintField("sectors_written", end.sectorsWritten - start->sectorsWritten);
+    PrintString("\n");
+}
@@ -0,0 +1,32 @@
+/* benchlib.h
+ *	Routines shared by the benchmark programs: printing to the
+ *	console without a C library, and reporting what a benchmark
+ *	used, as measured by the kernel (GetUsage).
+ *
+ *	Each result is one line of "key=value" pairs starting with
+ *	"BENCH", in the same form as "nachos -bench" uses, e.g.
+ *
+ *	BENCH name=chase bytes=4096 ops=20000 user_ticks=... system_ticks=...
+ *
+ *	The benchmarks end with Halt, so that the kernel also prints its
+ *	statistics for the whole run.  runbench runs them all.
+ */
+
+#ifndef BENCHLIB_H
+#define BENCHLIB_H
+
+#include "syscall.h"
+
+void PrintString(char *s);		/* to the console */
+void PrintInt(int n);
+
+/* Note what the program has used so far, in "start" */
+void BenchStart(Usage *start);
+
+/* Print a BENCH line for "ops" operations, charging what the program
+ * used since BenchStart.  "param" is the name of the parameter that
+ * was varied, and "value" its value; "param" may be 0.
+ */
+void BenchReport(char *name, char *param, int value, int ops, Usage *start);
+
+#endif /* BENCHLIB_H */
@@ -0,0 +1,45 @@
+/* chase.c
+ *	Benchmark: pointer chasing over a growing working set.  Each
+ *	element holds the index of the next one to visit, in a single
+ *	cycle that strides a page at a time, so every load depends on
+ *	the last and successive loads land on different pages.
+ *
+ *	Once the working set is bigger than the TLB (or physical
+ *	memory), the misses (or page faults) per load jump; where that
+ *	happens shows how big they effectively are.
+ */
+
+#include "benchlib.h"
+
+#define MaxWords	4096	/* working sets up to 16KB */
+#define Loads		4096	/* loads per working set */
+#define Stride		37	/* words; odd, and more than a page (128 bytes) */
+
+int next[MaxWords];
+
+int
+main()
+{
+    Usage start;
+    int words, i, p, sum = 0;
+
+    for (words = 64; words <= MaxWords; words *= 2) {
+	/* Stride is odd and words a power of two, so this is one cycle
+	 * through all of the elements */
+	for (i = 0; i < words; i++)
+	    next[i] = (i + Stride) % words;
+
+	BenchStart(&start);
+	p = 0;
+	for (i = 0; i < Loads; i++) {
+	    p = next[p];
+	    sum += p;
+	}
+	BenchReport("chase", "bytes", words * sizeof(int), Loads, &start);
+    }
+
+    if (sum < 0)
+	PrintString("chase: bad sum\n");
+    Halt();
+    /* not reached */
+}
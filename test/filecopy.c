@@ -0,0 +1,56 @@
+/* filecopy.c
+ *	Benchmark: copy a file with buffers of several sizes, to show
+ *	what each Read and Write costs against the bytes it moves.
+ */
+
+#include "benchlib.h"
+
+#define FileSize	2048
+#define MaxBuffer	1024
+
+char buffer[MaxBuffer];
+
+static int sizes[] = { 16, 64, 256, 1024 };
+#define NumSizes	(sizeof(sizes) / sizeof(sizes[0]))
+
+int
+main()
+{
+    Usage start;
+    OpenFileId src, dst;
+    int i, n, total;
+
+    /* make the file to copy */
+    Create("bench.src");
+    src = Open("bench.src");
+    if (src < 0) {
+	PrintString("filecopy: can't create bench.src\n");
+	Halt();
+    }
+    for (i = 0; i < MaxBuffer; i++)
+	buffer[i] = 'a' + i % 26;
+    for (i = 0; i < FileSize; i += MaxBuffer)
+	Write(buffer, MaxBuffer, src);
+    Close(src);
+
+    for (i = 0; i < NumSizes; i++) {
+	Create("bench.dst");
+	src = Open("bench.src");
+	dst = Open("bench.dst");
+
+	BenchStart(&start);
+	total = 0;
+	while (total < FileSize
+		&& (n = Read(buffer, sizes[i], src)) > 0) {
+	    Write(buffer, n, dst);
+	    total += n;
+	}
+	BenchReport("filecopy", "buffer", sizes[i], total, &start);
+
+	Close(src);
+	Close(dst);
+    }
+
+    Halt();
+    /* not reached */
+}
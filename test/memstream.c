@@ -0,0 +1,35 @@
+/* memstream.c
+ *	Benchmark: stream through an array, as STREAM does, writing it
+ *	and then reading it back, for several passes.  Every page of the
+ *	array is touched on each pass, so with a small memory (or TLB)
+ *	this measures how fast the kernel can bring pages back in.
+ */
+
+#include "benchlib.h"
+
+#define Words	2048		/* an 8KB array */
+#define Passes	8
+
+int a[Words];			/* too big for the stack */
+
+int
+main()
+{
+    Usage start;
+    int pass, i, sum = 0;
+
+    BenchStart(&start);
+    for (pass = 0; pass < Passes; pass++) {
+	for (i = 0; i < Words; i++)
+	    a[i] = i + pass;
+	for (i = 0; i < Words; i++)
+	    sum += a[i];
+    }
+    BenchReport("memstream", "bytes", Words * sizeof(int),
+		2 * Words * Passes, &start);
+
+    if (sum == 0)		/* so the loops aren't optimized away */
+	PrintString("memstream: bad sum\n");
+    Halt();
+    /* not reached */
+}
@@ -0,0 +1,25 @@
+/* nullcall.c
+ *	Benchmark: the cost of a system call that does nothing -- a Read
+ *	of no bytes from a descriptor that isn't open -- to measure the
+ *	trap into the kernel and back.
+ */
+
+#include "benchlib.h"
+
+#define Calls	1000
+
+int
+main()
+{
+    Usage start;
+    char c;
+    int i;
+
+    BenchStart(&start);
+    for (i = 0; i < Calls; i++)
+	Read(&c, 0, -1);
+    BenchReport("nullcall", 0, 0, Calls, &start);
+
+    Halt();
+    /* not reached */
+}
@@ -0,0 +1,48 @@
+/* pingpong.c
+ *	Benchmark: bounce a byte back and forth between two programs
+ *	over a pair of pipes, to measure a round trip through the pipe
+ *	code and the scheduler.
+ *
+ *	The child (pongchild) inherits our descriptors, with the same
+ *	numbers; since Exec can't pass arguments, the numbers are fixed
+ *	here and in pongchild.c.
+ */
+
+#include "benchlib.h"
+#include "pingpong.h"
+
+#define Rounds	100
+
+int
+main()
+{
+    Usage start;
+    OpenFileId toChild[2], toParent[2];
+    int i, id;
+    char c = 'x';
+
+    if (Pipe(toChild) < 0 || Pipe(toParent) < 0
+	    || toChild[0] != PingRead || toChild[1] != PingWrite
+	    || toParent[0] != PongRead || toParent[1] != PongWrite) {
+	PrintString("pingpong: pipes are not where pongchild expects\n");
+	Halt();
+    }
+    id = Exec(PongChild);
+    if (id < 0) {
+	PrintString("pingpong: can't exec " PongChild "\n");
+	Halt();
+    }
+
+    BenchStart(&start);
+    for (i = 0; i < Rounds; i++) {
+	Write(&c, 1, PingWrite);
+	if (Read(&c, 1, PongRead) != 1)
+	    break;
+    }
+    BenchReport("pingpong", 0, 0, i, &start);
+
+    Close(PingWrite);		/* tells the child we're done */
+    Join(id);
+    Halt();
+    /* not reached */
+}
@@ -0,0 +1,17 @@
+/* pingpong.h
+ *	What pingpong and pongchild agree on: where the pipes are.  The
+ *	parent makes the pipe to the child first, and descriptors 0 and
+ *	1 are the console, so the pipe ends get these numbers.
+ */
+
+#ifndef PINGPONG_H
+#define PINGPONG_H
+
+#define PingRead	2	/* parent to child */
+#define PingWrite	3
+#define PongRead	4	/* child to parent */
+#define PongWrite	5
+
+#define PongChild	"../test/pongchild"
+
+#endif /* PINGPONG_H */
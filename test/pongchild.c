@@ -0,0 +1,19 @@
+/* pongchild.c
+ *	The other half of pingpong: send back each byte we're sent,
+ *	until the parent closes its end of the pipe.
+ */
+
+#include "syscall.h"
+#include "pingpong.h"
+
+int
+main()
+{
+    char c;
+
+    Close(PingWrite);		/* or we'd never see end of file */
+    while (Read(&c, 1, PingRead) == 1)
+	Write(&c, 1, PongWrite);
+    Exit(0);
+    /* not reached */
+}
@@ -0,0 +1,35 @@
+/* spawn.c
+ *	Benchmark: start a trivial program and wait for it to finish,
+ *	over and over, to measure what Exec and Join cost, from loading
+ *	the NOFF file to tearing down the address space.
+ *
+ *	User-level Fork is not measured: a forked thread shares the
+ *	stack of the thread that forked it, so it can't safely return
+ *	(or Exit, which frees the whole address space).
+ */
+
+#include "benchlib.h"
+
+#define Children	20
+#define Child		"../test/spawnchild"
+
+int
+main()
+{
+    Usage start;
+    int i, id;
+
+    BenchStart(&start);
+    for (i = 0; i < Children; i++) {
+	id = Exec(Child);
+	if (id < 0) {
+	    PrintString("spawn: can't exec " Child "\n");
+	    Halt();
+	}
+	Join(id);
+    }
+    BenchReport("spawn", 0, 0, Children, &start);
+
+    Halt();
+    /* not reached */
+}
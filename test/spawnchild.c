@@ -0,0 +1,12 @@
+/* spawnchild.c
+ *	The program started by spawn: it does nothing at all.
+ */
+
+#include "syscall.h"
+
+int
+main()
+{
+    Exit(0);
+    /* not reached */
+}
@@ -146,6 +146,54 @@ Ls:
   syscall
   j	$31
   .end Ls
+
+  .globl Pipe
+  .ent	Pipe
+Pipe:
+  addiu $2,$0,SC_Pipe
+  syscall
+  j	$31
+  .end Pipe
+
+  .globl PRead
+  .ent	PRead
+PRead:
+  addiu $2,$0,SC_PRead
+  syscall
+  j	$31
+  .end PRead
+
+  .globl PWrite
+  .ent	PWrite
+PWrite:
+  addiu $2,$0,SC_PWrite
+  syscall
+  j	$31
+  .end PWrite
+
+  .globl ReadV
+  .ent	ReadV
+ReadV:
+  addiu $2,$0,SC_ReadV
+  syscall
+  j	$31
+  .end ReadV
+
+  .globl WriteV
+  .ent	WriteV
+WriteV:
+  addiu $2,$0,SC_WriteV
+  syscall
+  j	$31
+  .end WriteV
+
+  .globl GetUsage
+  .ent	GetUsage
+GetUsage:
+  addiu $2,$0,SC_GetUsage
+  syscall
+  j	$31
+  .end GetUsage
   /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 /* dummy function to keep gcc happy */
@@ -0,0 +1,579 @@
+// benchmark.cc
+//	Microbenchmarks of the Nachos kernel, run with
+//
+//		nachos -bench <name> [params]
+//
+//	Unlike the tests, these print nothing while they run (LOG
+//	messages are turned down to errors), and sizes are parameters.
+//	Each reports the simulated ticks and the host wall clock time it
+//	took, in words and then as one line of "key=value" pairs starting
+//	with "BENCH", for scripts that track performance over time:
+//
+//	BENCH name=yield threads=2 iters=10000 ops=20000 ticks=... host_usec=...
+//
+//	The benchmarks available depend on the assignment: the thread and
+//	synchronization ones everywhere, the rest only where the kernel
+//	has address spaces, pipes or a file system.  "nachos -bench"
+//	with no name lists them.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "synch.h"
+#ifdef USER_PROGRAM
+#include "addrspace.h"
+#include "synchpipe.h"
+#endif
+
+static int startTicks;			// when the timed part began
+static double startHost;
+
+static Semaphore *done;			// each worker V()s it when finished
+static int iterations;			// per worker
+static int counter;			// shared by the workers
+
+//----------------------------------------------------------------------
+// Param
+// 	Return parameter "i" of the benchmark, or "deflt" if there are
+//	not that many.
+//----------------------------------------------------------------------
+
+static int
+Param(int argc, char **argv, int i, int deflt)
+{
+    return (i < argc) ? atoi(argv[i]) : deflt;
+}
+
+//----------------------------------------------------------------------
+// StartTiming, Report
+// 	Bracket the part of a benchmark being measured.  Report prints
+//	the results, with "params" (a string of "key=value" pairs) saying
+//	how the benchmark was run, and "ops" how many operations it did.
+//----------------------------------------------------------------------
+
+static void
+StartTiming()
+{
+    startTicks = stats->totalTicks;
+    startHost = HostTime();
+}
+
+static void
+Report(char *name, char *params, int ops)
+{
+    int ticks = stats->totalTicks - startTicks;
+    double usec = (HostTime() - startHost) * 1000000.0;
+
+    if (ops <= 0)
+	ops = 1;
+    printf("%s: %d ops in %d ticks (%.1f ticks/op), %.0f usec on the host "
+	   "(%.3f usec/op)\n", name, ops, ticks, (double) ticks / ops, usec,
+	   usec / ops);
+    printf("BENCH name=%s %s ops=%d ticks=%d host_usec=%.0f\n",
+	   name, params, ops, ticks, usec);
+}
+
+//----------------------------------------------------------------------
+// ForkWorker
+// 	Start a worker thread running "func(arg)".  It gets our priority,
+//	so that it neither preempts us nor waits behind everyone else.
+//----------------------------------------------------------------------
+
+static void
+ForkWorker(VoidFunctionPtr func, int arg)
+{
+    Thread *t = new Thread("bench worker");
+
+    t->setPriority(currentThread->getPriority());
+    t->Fork(func, arg);
+}
+
+//----------------------------------------------------------------------
+// yield [iters]
+// 	Two threads hand the CPU back and forth with Yield.
+//----------------------------------------------------------------------
+
+static void
+YieldWorker(int which)
+{
+    for (int i = 0; i < iterations; i++)
+	currentThread->Yield();
+    done->V();
+}
+
+static void
+YieldBench(int argc, char **argv)
+{
+    char params[64];
+
+    iterations = Param(argc, argv, 0, 10000);
+    sprintf(params, "threads=2 iters=%d", iterations);
+
+    StartTiming();
+    ForkWorker(YieldWorker, 0);
+    ForkWorker(YieldWorker, 1);
+    done->P();
+    done->P();
+    Report("yield", params, 2 * iterations);
+}
+
+//----------------------------------------------------------------------
+// sem [iters]
+// 	Two threads pass control back and forth through a pair of
+//	semaphores.  Each handoff puts one thread to sleep and wakes the
+//	other.
+//----------------------------------------------------------------------
+
+static Semaphore *ping, *pong;
+
+static void
+PingWorker(int which)
+{
+    for (int i = 0; i < iterations; i++) {
+	ping->V();
+	pong->P();
+    }
+    done->V();
+}
+
+static void
+PongWorker(int which)
+{
+    for (int i = 0; i < iterations; i++) {
+	ping->P();
+	pong->V();
+    }
+    done->V();
+}
+
+static void
+SemaphoreBench(int argc, char **argv)
+{
+    char params[64];
+
+    iterations = Param(argc, argv, 0, 10000);
+    sprintf(params, "iters=%d", iterations);
+    ping = new Semaphore("bench ping", 0);
+    pong = new Semaphore("bench pong", 0);
+
+    StartTiming();
+    ForkWorker(PingWorker, 0);
+    ForkWorker(PongWorker, 1);
+    done->P();
+    done->P();
+    Report("sem", params, 2 * iterations);
+
+    delete ping;
+    delete pong;
+}
+
+//----------------------------------------------------------------------
+// lock [threads] [iters]
+// 	Threads take turns with one lock.  Each yields while holding it,
+//	so the others pile up waiting in Acquire.
+//----------------------------------------------------------------------
+
+static Lock *benchLock;
+
+static void
+LockWorker(int which)
+{
+    for (int i = 0; i < iterations; i++) {
+	benchLock->Acquire();
+	counter++;
+	currentThread->Yield();
+	benchLock->Release();
+    }
+    done->V();
+}
+
+static void
+LockBench(int argc, char **argv)
+{
+    int threads = Param(argc, argv, 0, 4);
+    char params[64];
+
+    iterations = Param(argc, argv, 1, 1000);
+    sprintf(params, "threads=%d iters=%d", threads, iterations);
+    benchLock = new Lock("bench lock");
+    counter = 0;
+
+    StartTiming();
+    for (int i = 0; i < threads; i++)
+	ForkWorker(LockWorker, i);
+    for (int i = 0; i < threads; i++)
+	done->P();
+    Report("lock", params, threads * iterations);
+
+    ASSERT(counter == threads * iterations);
+    delete benchLock;
+}
+
+//----------------------------------------------------------------------
+// prodcons [items] [slots]
+// 	A producer and a consumer pass items through a bounded buffer,
+//	guarded by a lock and two condition variables.
+//----------------------------------------------------------------------
+
+static Condition *notFull, *notEmpty;
+static int slots, inBuffer;
+
+static void
+ProducerWorker(int which)
+{
+    for (int i = 0; i < iterations; i++) {
+	benchLock->Acquire();
+	while (inBuffer == slots)
+	    notFull->Wait(benchLock);
+	inBuffer++;
+	notEmpty->Signal(benchLock);
+	benchLock->Release();
+    }
+    done->V();
+}
+
+static void
+ConsumerWorker(int which)
+{
+    for (int i = 0; i < iterations; i++) {
+	benchLock->Acquire();
+	while (inBuffer == 0)
+	    notEmpty->Wait(benchLock);
+	inBuffer--;
+	counter++;
+	notFull->Signal(benchLock);
+	benchLock->Release();
+    }
+    done->V();
+}
+
+static void
+ProdConsBench(int argc, char **argv)
+{
+    char params[64];
+
+    iterations = Param(argc, argv, 0, 10000);
+    slots = Param(argc, argv, 1, 8);
+    ASSERT(slots > 0);
+    sprintf(params, "items=%d slots=%d", iterations, slots);
+    benchLock = new Lock("bench buffer lock");
+    notFull = new Condition("bench not full");
+    notEmpty = new Condition("bench not empty");
+    inBuffer = counter = 0;
+
+    StartTiming();
+    ForkWorker(ProducerWorker, 0);
+    ForkWorker(ConsumerWorker, 1);
+    done->P();
+    done->P();
+    Report("prodcons", params, iterations);
+
+    ASSERT(counter == iterations && inBuffer == 0);
+    delete notFull;
+    delete notEmpty;
+    delete benchLock;
+}
+
+#ifdef USER_PROGRAM
+//----------------------------------------------------------------------
+// pagefault [program] [rounds]
+// 	Load a user program, then over and over throw out all of its
+//	pages and touch each one again, so that every touch goes through
+//	the fault handler.  Without a TLB the handler loads the page from
+//	the program file; with one (-DUSE_TLB) the pages stay in memory
+//	and each touch is a TLB miss instead.
+//----------------------------------------------------------------------
+
+static void
+PageFaultBench(int argc, char **argv)
+{
+    char *program = (argc > 0) ? argv[0] : (char *) "../test/matmult";
+    int rounds = Param(argc, argv, 1, 20);
+    int faults = stats->numPageFaults + stats->numTlbMisses;
+    char params[128];
+    OpenFile *executable = fileSystem->Open(program);
+    AddrSpace *space;
+    int value;
+
+    if (executable == NULL) {
+	printf("Unable to open file %s\n", program);
+	return;
+    }
+    space = new AddrSpace(executable, program);
+    delete executable;
+    currentThread->space = space;
+    currentThread->userProgFilename = program;
+    space->InitRegisters();
+    space->RestoreState();
+    sprintf(params, "program=%.64s pages=%d rounds=%d tlb=%d", program,
+	    space->getNumPages(), rounds, machine->tlb != NULL);
+
+    StartTiming();
+    for (int r = 0; r < rounds; r++) {
+	if (machine->tlb != NULL) {
+	    for (int i = 0; i < TLBSize; i++)
+		machine->tlb[i].valid = FALSE;
+	} else {
+	    for (int vpn = 0; vpn < space->getNumPages(); vpn++)
+		if (machine->pageTable[vpn].valid) {
+		    machine->ReleaseFrame(machine->pageTable[vpn].physicalPage);
+		    machine->pageTable[vpn].valid = FALSE;
+		}
+	}
+	machine->FlushTranslateMemo();
+
+	for (int vpn = 0; vpn < space->getNumPages(); vpn++) {
+	    int tries = 0;
+
+	    // ReadMem runs the fault handler and fails; then it works
+	    while (!machine->ReadMem(vpn * PageSize, 4, &value))
+		ASSERT(++tries < 3);
+	}
+    }
+    interrupt->setStatus(SystemMode);	// RaiseException left us in
+					// user mode
+    faults = stats->numPageFaults + stats->numTlbMisses - faults;
+    Report("pagefault", params, faults);
+}
+
+//----------------------------------------------------------------------
+// pipe [bytes] [chunk]
+// 	One thread writes "bytes" through a pipe in pieces of "chunk",
+//	and another reads them out.
+//----------------------------------------------------------------------
+
+static SynchPipe *benchPipe;
+static int pipeBytes, pipeChunk;
+
+static void
+PipeWriter(int which)
+{
+    char *buf = new char[pipeChunk];
+
+    memset(buf, 'x', pipeChunk);
+    for (int sent = 0; sent < pipeBytes; sent += pipeChunk)
+	benchPipe->Write(buf, min(pipeChunk, pipeBytes - sent));
+    benchPipe->CloseEnd(TRUE);
+    delete [] buf;
+    done->V();
+}
+
+static void
+PipeReader(int which)
+{
+    char *buf = new char[pipeChunk];
+    int n;
+
+    while ((n = benchPipe->Read(buf, pipeChunk)) > 0)
+	counter += n;
+    benchPipe->CloseEnd(FALSE);
+    delete [] buf;
+    done->V();
+}
+
+static void
+PipeBench(int argc, char **argv)
+{
+    char params[64];
+
+    pipeBytes = Param(argc, argv, 0, 65536);
+    pipeChunk = Param(argc, argv, 1, 64);
+    ASSERT(pipeChunk > 0);
+    sprintf(params, "bytes=%d chunk=%d", pipeBytes, pipeChunk);
+    benchPipe = new SynchPipe("bench pipe");
+    counter = 0;
+
+    StartTiming();
+    ForkWorker(PipeWriter, 0);
+    ForkWorker(PipeReader, 1);
+    done->P();
+    done->P();
+    Report("pipe", params, divRoundUp(pipeBytes, pipeChunk));
+
+    ASSERT(counter == pipeBytes);
+    delete benchPipe;
+}
+#endif // USER_PROGRAM
+
+#ifdef FILESYS_NEEDED
+#define BenchFileName	"benchfile"
+
+//----------------------------------------------------------------------
+// CreateBenchFile
+// 	Make an empty file of "size" bytes to read and write, and open it.
+//----------------------------------------------------------------------
+
+static OpenFile *
+CreateBenchFile(int size)
+{
+    fileSystem->Remove(BenchFileName);		// from an earlier run
+    if (!fileSystem->Create(BenchFileName, size))
+	return NULL;
+    return fileSystem->Open(BenchFileName);
+}
+
+//----------------------------------------------------------------------
+// fsseq [size] [chunk]
+// 	Write a file from start to end in pieces of "chunk" bytes, then
+//	read it back the same way.
+//----------------------------------------------------------------------
+
+static void
+FsSeqBench(int argc, char **argv)
+{
+    int size = Param(argc, argv, 0, 8192);
+    int chunk = Param(argc, argv, 1, 128);
+    char params[64];
+    OpenFile *file;
+    char *buf;
+    int ops = 0;
+
+    ASSERT(chunk > 0);
+    sprintf(params, "size=%d chunk=%d", size, chunk);
+    if ((file = CreateBenchFile(size)) == NULL) {
+	printf("fsseq: unable to create %s\n", BenchFileName);
+	return;
+    }
+    buf = new char[chunk];
+    memset(buf, 'x', chunk);
+
+    StartTiming();
+    for (int pos = 0; pos < size; pos += chunk, ops++)
+	file->WriteAt(buf, min(chunk, size - pos), pos);
+    for (int pos = 0; pos < size; pos += chunk, ops++)
+	file->ReadAt(buf, min(chunk, size - pos), pos);
+    Report("fsseq", params, ops);
+
+    delete [] buf;
+    delete file;
+    fileSystem->Remove(BenchFileName);
+}
+
+//----------------------------------------------------------------------
+// fsrand [size] [chunk] [ops]
+// 	Read and write pieces of "chunk" bytes at random places in a file,
+//	half reads and half writes.
+//----------------------------------------------------------------------
+
+static void
+FsRandBench(int argc, char **argv)
+{
+    int size = Param(argc, argv, 0, 8192);
+    int chunk = Param(argc, argv, 1, 128);
+    int ops = Param(argc, argv, 2, 200);
+    int pieces = divRoundUp(size, chunk);
+    char params[64];
+    OpenFile *file;
+    char *buf;
+
+    ASSERT(chunk > 0 && chunk <= size);
+    sprintf(params, "size=%d chunk=%d", size, chunk);
+    if ((file = CreateBenchFile(size)) == NULL) {
+	printf("fsrand: unable to create %s\n", BenchFileName);
+	return;
+    }
+    buf = new char[chunk];
+    memset(buf, 'x', chunk);
+
+    StartTiming();
+    for (int i = 0; i < ops; i++) {
+	int pos = (Random() % pieces) * chunk;
+	int len = min(chunk, size - pos);
+
+	if (i % 2 == 0)
+	    file->WriteAt(buf, len, pos);
+	else
+	    file->ReadAt(buf, len, pos);
+    }
+    Report("fsrand", params, ops);
+
+    delete [] buf;
+    delete file;
+    fileSystem->Remove(BenchFileName);
+}
+
+//----------------------------------------------------------------------
+// churn [files] [size]
+// 	Create a file and remove it again, over and over.
+//----------------------------------------------------------------------
+
+static void
+ChurnBench(int argc, char **argv)
+{
+    int files = Param(argc, argv, 0, 100);
+    int size = Param(argc, argv, 1, 0);
+    char params[64];
+    char name[16];
+
+    sprintf(params, "files=%d size=%d", files, size);
+
+    StartTiming();
+    for (int i = 0; i < files; i++) {
+	sprintf(name, "churn%d", i);
+	if (!fileSystem->Create(name, size)) {
+	    printf("churn: unable to create %s\n", name);
+	    return;
+	}
+	fileSystem->Remove(name);
+    }
+    Report("churn", params, 2 * files);
+}
+#endif // FILESYS_NEEDED
+
+// The benchmarks, by name
+
+struct BenchInfo {
+    char *name;
+    void (*func)(int argc, char **argv);
+    char *params;			// for the usage message
+};
+
+static BenchInfo benchmarks[] = {
+    { "yield", YieldBench, "[iters]" },
+    { "sem", SemaphoreBench, "[iters]" },
+    { "lock", LockBench, "[threads] [iters]" },
+    { "prodcons", ProdConsBench, "[items] [slots]" },
+#ifdef USER_PROGRAM
+    { "pagefault", PageFaultBench, "[program] [rounds]" },
+    { "pipe", PipeBench, "[bytes] [chunk]" },
+#endif
+#ifdef FILESYS_NEEDED
+    { "fsseq", FsSeqBench, "[size] [chunk]" },
+    { "fsrand", FsRandBench, "[size] [chunk] [ops]" },
+    { "churn", ChurnBench, "[files] [size]" },
+#endif
+};
+
+#define NumBenchmarks	(int) (sizeof(benchmarks) / sizeof(benchmarks[0]))
+
+//----------------------------------------------------------------------
+// Benchmark
+// 	Run the benchmark called "name", with its parameters, then halt.
+//	Only errors are logged while it runs.
+//
+//	"argc", "argv" -- the parameters
+//----------------------------------------------------------------------
+
+void
+Benchmark(char *name, int argc, char **argv)
+{
+    int oldLogLevel = logLevel;
+
+    for (int i = 0; i < NumBenchmarks; i++)
+	if (name != NULL && !strcmp(name, benchmarks[i].name)) {
+	    done = new Semaphore("bench done", 0);
+	    logLevel = LogError;
+	    (*benchmarks[i].func)(argc, argv);
+	    logLevel = oldLogLevel;
+	    delete done;
+	    interrupt->Halt();
+	}
+
+    printf("Usage: nachos -bench <name> [params], where <name> is one of:\n");
+    for (int i = 0; i < NumBenchmarks; i++)
+	printf("\t%s %s\n", benchmarks[i].name, benchmarks[i].params);
+    interrupt->Halt();
+}
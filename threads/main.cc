@@ -8,9 +8,13 @@
 //
 // 	Most of this file is not needed until later assignments.
 //
-// Usage: nachos -d <debugflags> -rs <random seed #>
+// Usage: nachos -d <debugflags> -rs <random seed #> -stats -lockstat
+//		-trace <file> -log <level> -bench <name> [params]
+//		-record <file> -replay <file>
 //		-s -x <nachos file> -c <consoleIn> <consoleOut>
-//		-f -cp <unix file> <nachos file>
+//		-mem <bytes> -pagesize <bytes> -tlb <entries> -prof <ticks>
+//		-mips <minimum>
+//		-f -cp <unix file> <nachos file> -diskstats
 //		-p <nachos file> -r <nachos file> -l -D -t
 //              -n <network reliability> -m <machine id>
 //              -o <other machine id>
@@ -18,12 +22,31 @@
 //
 //    -d causes certain debugging messages to be printed (cf. utility.h)
 //    -rs causes Yield to occur at random (but repeatable) spots
+//    -stats prints what each thread and program used, at halt
+//    -lockstat prints, at halt, how often each kind of lock, semaphore
+//	and condition variable was waited for, and for how long (see synch.h)
+//    -trace records kernel events in <file> (see bin/trace2json)
+//    -log prints kernel messages up to <level>: 0 errors only, 1 also
+//	what the kernel does, 2 (the default) also each page it touches
+//    -record logs the run's nondeterministic inputs (random numbers,
+//	console and network input) in <file>; -replay feeds them back
+//	in from <file>, so the run repeats tick for tick (see replay.h)
+//    -bench runs a kernel microbenchmark and halts (see benchmark.cc);
+//	with no name, lists them
 //    -z prints the copyright message
 //
 //  USER_PROGRAM
 //    -s causes user programs to be executed in single-step mode
 //    -x runs a user program
 //    -c tests the console
+//    -mem sets the size of physical memory (e.g. 64M, 512K)
+//    -pagesize sets the page size in bytes (a multiple of 4)
+//    -tlb sets the number of TLB entries
+//    -prof samples the running user program every <ticks> user ticks,
+//	and prints where each program spent its time (see profile.h)
+//    -mips prints, at halt, how many million user instructions a second
+//	the simulator ran and where its host time went; Nachos exits with
+//	status 1 if that was below <minimum> (0 for no minimum)
 //
 //  FILESYS
 //    -f causes the physical disk to be formatted
@@ -33,11 +56,18 @@
 //    -l lists the contents of the Nachos directory
 //    -D prints the contents of the entire file system
 //    -t tests the performance of the Nachos file system
+//    -diskstats prints, at halt, histograms of disk latency, the
+//	access pattern, and the requests for each file (see disk.h)
 //
 //  NETWORK
 //    -n sets the network reliability
 //    -m sets this machine's host id (needed for the network)
+//    -txq sets how many packets can wait to be sent
+//    -netcfg reads the model of the network's links from a file
 //    -o runs a simple test of the Nachos network software
+//    -ro runs a test of reliable delivery over the network
+//    -cluster simulates that many machines, 0 to n-1, in this process
+//    -ring passes a token around the cluster that many times
 //
 //  NOTE -- flags are ignored until the relevant assignment.
 //  Some of the flags are interpreted here; some in system.cc.
@@ -63,6 +93,8 @@ extern void ThreadTest(void), Copy(char *unixFile, char *nachosFile);
 extern void Print(char *file), PerformanceTest(void);
 extern void StartProcess(char *file), ConsoleTest(char *in, char *out);
 extern void MailTest(int networkID);
+extern void ReliableTest(int networkID);
+extern void RingTest(int rounds);
 extern void PrintHello();
 extern void ThreadNumTest(), ThreadPrintTest();
 extern void StartMultiProcess(char *file1, char *file2);
@@ -70,6 +102,7 @@ extern void CreateDir(char* name);
 extern void ReaderWriterTest(void);
 extern void ConsoleToPipe(void), PipeToConsole(void);
 extern void PipeTest(void), PipeTestChild(int arg);
+extern void Benchmark(char *name, int argc, char **argv);
 
 //----------------------------------------------------------------------
 // main
@@ -94,6 +127,12 @@ main(int argc, char **argv)
     DEBUG('t', "Entering main");
     (void) Initialize(argc, argv);
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    for (int i = 1; i < argc; i++)
+	if (!strcmp(argv[i], "-bench"))	// run a benchmark, then halt
+	    Benchmark(argv[i + 1], argc - i - 2, argv + i + 2);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
     //PrintHello();
 
 #ifdef THREADS
@@ -192,6 +231,15 @@ main(int argc, char **argv)
 						// start up another nachos
             MailTest(atoi(*(argv + 1)));
             argCount = 2;
+        } else if (!strcmp(*argv, "-ro")) {	// reliable delivery test
+	    ASSERT(argc > 1);
+            Delay(2);
+            ReliableTest(atoi(*(argv + 1)));
+            argCount = 2;
+        } else if (!strcmp(*argv, "-ring")) {	// token ring over a cluster
+	    ASSERT(argc > 1);
+            RingTest(atoi(*(argv + 1)));
+            argCount = 2;
         }
 #endif // NETWORK
     }
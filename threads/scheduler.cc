@@ -64,6 +64,9 @@ Scheduler::ReadyToRun (Thread *thread)
     DEBUG('t', "Putting thread %s on ready list.\n", thread->getName());
 
     thread->setStatus(READY);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    TRACE(TraceReady, thread->getThreadID(), 0);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     //readyList->Append((void *)thread);
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     readyList->SortedInsert((void *)thread, thread->getPriority());
@@ -79,7 +82,7 @@ Scheduler::MultiQueueReadyToRun (Thread *thread, int priority)
     thread->setStatus(READY);
     priorityReadyList[priority]->Append((void *)thread);
 
-    printf("\nPutting thread %d on ready list %d...\n\n", thread->getThreadID(), priority);
+    LOG(LogInfo, "\nPutting thread %d on ready list %d...\n\n", thread->getThreadID(), priority);
 }
 
 Thread *
@@ -139,6 +142,15 @@ Scheduler::Run (Thread *nextThread)
 
     oldThread->CheckOverflow();		    // check if the old thread
 					    // had an undetected stack overflow
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    // count the switch as UNIX does: voluntary if the old thread blocked,
+    // involuntary if it could have gone on running
+    if (oldThread->getStatus() == BLOCKED)
+	oldThread->usage.voluntarySwitches++;
+    else
+	oldThread->usage.involuntarySwitches++;
+    TRACE(TraceSwitch, oldThread->getThreadID(), nextThread->getThreadID());
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     currentThread = nextThread;		    // switch to the next thread
 
@@ -26,19 +26,148 @@
 #include "system.h"
 #include "thread.h"
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+bool synchProfiling = FALSE;		// set by -lockstat
+static SynchStats *allSynchStats = NULL;	// the registry
+
+static char *synchKindNames[] = { "semaphore", "lock", "condition" };
+
+//----------------------------------------------------------------------
+// SynchStats::SynchStats
+// 	Initialize the statistics for the primitives of one kind and name.
+//----------------------------------------------------------------------
+
+SynchStats::SynchStats(SynchKind k, char *n)
+{
+    kind = k;
+    name = n;
+    instances = acquires = contended = 0;
+    waitTicks = maxWait = holdTicks = maxHold = 0;
+    next = NULL;
+}
+
+//----------------------------------------------------------------------
+// SynchStats::Acquired
+// 	Note that a primitive was acquired (P, Acquire, or the end of a
+//	Wait), now.
+//
+//	"since" is when the thread asked for it
+//	"waited" is whether it had to sleep first
+//----------------------------------------------------------------------
+
+void
+SynchStats::Acquired(int since, bool waited)
+{
+    int wait = stats->totalTicks - since;
+
+    acquires++;
+    if (waited)
+	contended++;
+    waitTicks += wait;
+    if (wait > maxWait)
+	maxWait = wait;
+}
+
+//----------------------------------------------------------------------
+// SynchStats::Released
+// 	Note that a lock acquired at tick "since" was released, now.
+//----------------------------------------------------------------------
+
+void
+SynchStats::Released(int since)
+{
+    int hold = stats->totalTicks - since;
+
+    holdTicks += hold;
+    if (hold > maxHold)
+	maxHold = hold;
+}
+
+//----------------------------------------------------------------------
+// SynchStats::Print
+// 	Print one line of the table made by PrintSynchStats.
+//----------------------------------------------------------------------
+
+void
+SynchStats::Print()
+{
+    printf("%-9s %-24s %5d %9d %9d %10d %8d", synchKindNames[kind], name,
+	instances, acquires, contended, waitTicks, maxWait);
+    if (kind == SynchLock)
+	printf(" %10d %8d", holdTicks, maxHold);
+    printf("\n");
+}
+
+//----------------------------------------------------------------------
+// FindSynchStats
+// 	Return the statistics kept for primitives of this kind and name,
+//	making them if this is the first one, and count one more
+//	primitive sharing them.  Returns NULL unless -lockstat.
+//----------------------------------------------------------------------
+
+SynchStats *
+FindSynchStats(SynchKind kind, char *name)
+{
+    SynchStats *s;
+
+    if (!synchProfiling)
+	return NULL;
+    for (s = allSynchStats; s != NULL; s = s->next)
+	if (s->kind == kind && !strcmp(s->name, name))
+	    break;
+    if (s == NULL) {
+	s = new SynchStats(kind, name);
+	s->next = allSynchStats;
+	allSynchStats = s;
+    }
+    s->instances++;
+    return s;
+}
+
+//----------------------------------------------------------------------
+// PrintSynchStats
+// 	Print the statistics of every kind and name of primitive that was
+//	used, the most waited-for first.  Called at Halt with -lockstat.
+//----------------------------------------------------------------------
+
+void
+PrintSynchStats()
+{
+    List *ranked = new List;
+    SynchStats *s;
+
+    for (s = allSynchStats; s != NULL; s = s->next)
+	if (s->acquires > 0)
+	    ranked->SortedInsert((void *)s, -s->waitTicks);
+
+    printf("Synchronization, by ticks spent waiting:\n");
+    printf("%-9s %-24s %5s %9s %9s %10s %8s %10s %8s\n", "kind", "name",
+	"count", "acquires", "contended", "wait", "max wait", "held",
+	"max held");
+    while ((s = (SynchStats *)ranked->Remove()) != NULL)
+	s->Print();
+    delete ranked;
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 //----------------------------------------------------------------------
 // Semaphore::Semaphore
 // 	Initialize a semaphore, so that it can be used for synchronization.
 //
 //	"debugName" is an arbitrary name, useful for debugging.
 //	"initialValue" is the initial value of the semaphore.
+//	"profile" is FALSE if the semaphore is part of something that
+//		keeps its own SynchStats
 //----------------------------------------------------------------------
 
-Semaphore::Semaphore(char* debugName, int initialValue)
+Semaphore::Semaphore(char* debugName, int initialValue, bool profile)
 {
     name = debugName;
     value = initialValue;
     queue = new List;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    synchStats = profile ? FindSynchStats(SynchSemaphore, debugName) : NULL;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 }
 
 //----------------------------------------------------------------------
@@ -66,6 +195,10 @@ void
 Semaphore::P()
 {
     IntStatus oldLevel = interrupt->SetLevel(IntOff);	// disable interrupts
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    int since = stats->totalTicks;
+    bool waited = (value == 0);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     while (value == 0) { 			// semaphore not available
 	      queue->Append((void *)currentThread);	// so go to sleep
@@ -74,6 +207,10 @@ Semaphore::P()
     }
     value--; 					// semaphore available,
 						// consume its value
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (synchStats != NULL)
+	synchStats->Acquired(since, waited);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
     (void) interrupt->SetLevel(oldLevel);	// re-enable interrupts
 }
@@ -109,7 +246,10 @@ Semaphore::V()
 Lock::Lock(char* debugName)
 {
     name = debugName;
-    lockSemaphore = new Semaphore(debugName, 1);
+    lockSemaphore = new Semaphore(debugName, 1, FALSE);
+    holdingThread = NULL;
+    synchStats = FindSynchStats(SynchLock, debugName);
+    acquireTime = 0;
 }
 Lock::~Lock()
 {
@@ -119,14 +259,21 @@ Lock::~Lock()
 void Lock::Acquire()
 {
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
+    int since = stats->totalTicks;
+    bool waited = (holdingThread != NULL);
     lockSemaphore->P();
     holdingThread = currentThread;
+    acquireTime = stats->totalTicks;
+    if (synchStats != NULL)
+	synchStats->Acquired(since, waited);
     (void) interrupt->SetLevel(oldLevel);
 }
 void Lock::Release()
 {
     IntStatus oldLevel = interrupt->SetLevel(IntOff);
     ASSERT(currentThread == holdingThread);
+    if (synchStats != NULL)
+	synchStats->Released(acquireTime);
     lockSemaphore->V();
     holdingThread = NULL;
     (void) interrupt->SetLevel(oldLevel);
@@ -141,6 +288,7 @@ Condition::Condition(char* debugName)
 {
     name = debugName;
     waitingList = new List;
+    synchStats = FindSynchStats(SynchCondition, debugName);
 }
 Condition::~Condition()
 {
@@ -153,9 +301,12 @@ void Condition::Wait(Lock* conditionLock)
 
     ASSERT(conditionLock->isHeldByCurrentThread());
 
+    int since = stats->totalTicks;
     conditionLock->Release();
     waitingList->Append(currentThread);
     currentThread->Sleep();
+    if (synchStats != NULL)		// until signalled, not until
+	synchStats->Acquired(since, TRUE);	// we have the lock again
     conditionLock->Acquire();
 
     (void) interrupt->SetLevel(oldLevel);
@@ -171,7 +322,7 @@ void Condition::Signal(Lock* conditionLock)
     if(signalThread != NULL)
     {
         scheduler->ReadyToRun(signalThread);
-        printf("thread %d ready to run\n", signalThread->getThreadID());
+        LOG(LogInfo, "thread %d ready to run\n", signalThread->getThreadID());
     }
 
     (void) interrupt->SetLevel(oldLevel);
@@ -21,6 +21,49 @@
 #include "thread.h"
 #include "list.h"
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+// With -lockstat, every semaphore, lock and condition variable keeps
+// count of how it is used, in a SynchStats shared by all the primitives
+// of its kind with the same name -- one for all of the SynchDisk's
+// "sector" semaphores, say, rather than one per sector.  At halt,
+// PrintSynchStats ranks them by the time threads spent waiting on
+// them, to show which one serializes the workload.
+//
+// For a semaphore, an "acquire" is a P; for a condition variable, a
+// Wait, which always waits.  Times are in simulated ticks.  Hold times
+// are only kept for locks, from Acquire to Release.
+
+enum SynchKind { SynchSemaphore, SynchLock, SynchCondition };
+
+class SynchStats {
+  public:
+    SynchStats(SynchKind kind, char *name);
+
+    void Acquired(int since, bool waited);	// note an acquire that
+					// started at tick "since"
+    void Released(int since);		// note a release of what was
+					// acquired at tick "since"
+    void Print();
+
+    SynchKind kind;
+    char *name;
+    int instances;			// # primitives sharing these stats
+    int acquires;
+    int contended;			// # acquires that had to wait
+    int waitTicks;			// total time waiting to acquire
+    int maxWait;
+    int holdTicks;			// total time held (locks)
+    int maxHold;
+    SynchStats *next;			// next in the registry
+};
+
+extern bool synchProfiling;		// -lockstat: keep SynchStats?
+extern SynchStats *FindSynchStats(SynchKind kind, char *name);
+					// the stats for primitives of this
+					// kind and name; NULL if not profiling
+extern void PrintSynchStats();		// ranked table, at halt
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 // The following class defines a "semaphore" whose value is a non-negative
 // integer.  The semaphore has only two operations P() and V():
 //
@@ -38,7 +81,10 @@
 
 class Semaphore {
   public:
-    Semaphore(char* debugName, int initialValue);	// set initial value
+    Semaphore(char* debugName, int initialValue, bool profile = TRUE);
+						// set initial value; a
+						// Lock's semaphore isn't
+						// profiled on its own
     ~Semaphore();   					// de-allocate semaphore
     char* getName() { return name;}			// debugging assist
 
@@ -49,6 +95,9 @@ class Semaphore {
     char* name;        // useful for debugging
     int value;         // semaphore value, always >= 0
     List *queue;       // threads waiting in P() for the value to be > 0
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    SynchStats *synchStats;		// -lockstat, else NULL
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 };
 
 // The following class defines a "lock".  A lock can be BUSY or FREE.
@@ -82,6 +131,10 @@ class Lock {
     Semaphore* lockSemaphore;
     Thread* holdingThread;
     // plus some other stuff you'll need to define
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    SynchStats *synchStats;		// -lockstat, else NULL
+    int acquireTime;			// when holdingThread got the lock
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 };
 
 // The following class defines a "condition variable".  A condition
@@ -135,6 +188,9 @@ class Condition {
     char* name;
     List* waitingList;
     // plus some other stuff you'll need to define
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    SynchStats *synchStats;		// -lockstat, else NULL
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 };
 //#endif // SYNCH_H
 
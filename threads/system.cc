@@ -22,6 +22,10 @@ Timer *timer;				// the hardware timer device,
 
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 SystemThreads systemThreads[MAX_THREAD];
+bool showUsage = FALSE;			// print per-thread usage at Halt?
+Trace *trace = NULL;			// kernel event trace, if -trace
+Replay *replay = NULL;			// input log, if -record or -replay
+int exitStatus = 0;			// what Cleanup exits with
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 
@@ -39,6 +43,9 @@ Machine *machine;	// user program memory and registers
 
 #ifdef NETWORK
 PostOffice *postOffice;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+Cluster *cluster = NULL;	// the simulated machines, if -cluster
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 #endif
 
 
@@ -70,6 +77,33 @@ TimerInterruptHandler(int dummy)
 	interrupt->YieldOnReturn();
 }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// ParseSize
+// 	Convert a size such as "4096", "64K" or "64M" to bytes.  The
+//	arithmetic is done in floating point, so that too big a size is
+//	caught rather than wrapping around.
+//----------------------------------------------------------------------
+#ifdef USER_PROGRAM
+static int
+ParseSize(char *str)
+{
+    double size = atof(str);
+    char unit = str[strlen(str) - 1];
+
+    if (unit == 'k' || unit == 'K')
+	size *= 1024;
+    else if (unit == 'm' || unit == 'M')
+	size *= 1024 * 1024;
+    if (size < 1 || size > 0x7fffffff) {
+	fprintf(stderr, "Size \"%s\" must be from 1 byte to 2047M\n", str);
+	Exit(1);
+    }
+    return (int) size;
+}
+#endif
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 //----------------------------------------------------------------------
 // Initialize
 // 	Initialize Nachos global data structures.  Interpret command
@@ -86,17 +120,29 @@ Initialize(int argc, char **argv)
     int argCount;
     char* debugArgs = "";
     bool randomYield = FALSE;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    char *traceFile = NULL;	// where to put the event trace
+    char *replayFile = NULL;	// -record or -replay log
+    bool replaying = FALSE;	// -replay
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 
 #ifdef USER_PROGRAM
     bool debugUserProg = FALSE;	// single step user program
+    int memBytes = 0;		// size of physical memory, 0 = default
 #endif
 #ifdef FILESYS_NEEDED
     bool format = FALSE;	// format disk
 #endif
+#ifdef FILESYS
+    bool showDiskStats = FALSE;	// -diskstats
+#endif
 #ifdef NETWORK
     double rely = 1;		// network reliability
     int netname = 0;		// UNIX socket name
+    int txQueue = NetworkTxQueue;	// # packets the network can queue
+    char *linkConfig = NULL;	// file describing the network's links
+    int numNodes = 0;		// # machines to simulate in this process
 #endif
 
     for (argc--, argv++; argc > 0; argc -= argCount, argv += argCount) {
@@ -115,14 +161,67 @@ Initialize(int argc, char **argv)
 	    randomYield = TRUE;
 	    argCount = 2;
 	}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+	else if (!strcmp(*argv, "-stats"))
+	    showUsage = TRUE;
+	else if (!strcmp(*argv, "-lockstat"))
+	    synchProfiling = TRUE;
+	else if (!strcmp(*argv, "-trace")) {
+	    ASSERT(argc > 1);
+	    traceFile = *(argv + 1);
+	    argCount = 2;
+	}
+	else if (!strcmp(*argv, "-log")) {
+	    ASSERT(argc > 1);
+	    logLevel = atoi(*(argv + 1));	// 0 errors only ... 2 everything
+	    argCount = 2;
+	}
+	else if (!strcmp(*argv, "-record") || !strcmp(*argv, "-replay")) {
+	    ASSERT(argc > 1);
+	    replaying = !strcmp(*argv, "-replay");
+	    replayFile = *(argv + 1);
+	    argCount = 2;
+	}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 #ifdef USER_PROGRAM
 	if (!strcmp(*argv, "-s"))
 	    debugUserProg = TRUE;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+	else if (!strcmp(*argv, "-mem")) {
+	    ASSERT(argc > 1);
+	    memBytes = ParseSize(*(argv + 1));
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-pagesize")) {
+	    ASSERT(argc > 1);
+	    PageSize = ParseSize(*(argv + 1));
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-tlb")) {
+	    ASSERT(argc > 1);
+	    TLBSize = atoi(*(argv + 1));
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-prof")) {
+	    ASSERT(argc > 1);
+	    profileInterval = atoi(*(argv + 1));
+	    ASSERT(profileInterval >= 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-mips")) {
+	    ASSERT(argc > 1);
+	    minMips = atof(*(argv + 1));
+	    ASSERT(minMips >= 0);
+	    argCount = 2;
+	}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 #endif
 #ifdef FILESYS_NEEDED
 	if (!strcmp(*argv, "-f"))
 	    format = TRUE;
 #endif
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#ifdef FILESYS
+	if (!strcmp(*argv, "-diskstats"))
+	    showDiskStats = TRUE;
+#endif
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 #ifdef NETWORK
 	if (!strcmp(*argv, "-l")) {
 	    ASSERT(argc > 1);
@@ -133,6 +232,23 @@ Initialize(int argc, char **argv)
 	    netname = atoi(*(argv + 1));
 	    argCount = 2;
 	}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+	else if (!strcmp(*argv, "-txq")) {
+	    ASSERT(argc > 1);
+	    txQueue = atoi(*(argv + 1));
+	    ASSERT(txQueue > 0);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-netcfg")) {
+	    ASSERT(argc > 1);
+	    linkConfig = *(argv + 1);
+	    argCount = 2;
+	} else if (!strcmp(*argv, "-cluster")) {
+	    ASSERT(argc > 1);
+	    numNodes = atoi(*(argv + 1));
+	    ASSERT(numNodes > 0);
+	    argCount = 2;
+	}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 #endif
     }
 
@@ -143,6 +259,12 @@ Initialize(int argc, char **argv)
 
     DebugInit(debugArgs);			// initialize DEBUG messages
     stats = new Statistics();			// collect statistics
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (traceFile != NULL)			// start the event trace
+	trace = new Trace(traceFile);
+    if (replayFile != NULL)			// before anything draws a
+	replay = new Replay(replayFile, replaying);	// random number
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     interrupt = new Interrupt;			// start up interrupt handling
     scheduler = new Scheduler();		// initialize the ready queue
     if (randomYield)				// start the timer (if needed)
@@ -160,10 +282,29 @@ Initialize(int argc, char **argv)
     CallOnUserAbort(Cleanup);			// if user hits ctl-C
 
 #ifdef USER_PROGRAM
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    // word accesses must never straddle a page
+    ASSERT(PageSize >= 4 && PageSize % 4 == 0 && TLBSize > 0);
+    if (memBytes > 0)
+	NumPhysPages = divRoundUp(memBytes, PageSize);
+    if ((double) NumPhysPages * PageSize > 0x7fffffff) {
+	fprintf(stderr, "%d pages of %d bytes is more memory than we can "
+	    "simulate (2047M)\n", NumPhysPages, PageSize);
+	Exit(1);
+    }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     machine = new Machine(debugUserProg);	// this must come first
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (minMips >= 0)
+	machine->StartSampling();		// -mips: where the time goes
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 #endif
 
 #ifdef FILESYS
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (showDiskStats)
+	diskStats = new DiskStats;	// before the disk is touched
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     synchDisk = new SynchDisk("DISK");
 #endif
 
@@ -172,9 +313,43 @@ Initialize(int argc, char **argv)
 #endif
 
 #ifdef NETWORK
-    postOffice = new PostOffice(netname, rely, 10);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (numNodes > 0) {		// we are machine 0 of the cluster
+	cluster = new Cluster(numNodes);
+	cluster->Boot(rely, txQueue, linkConfig,
+			randomYield ? TimerInterruptHandler : NULL);
+    } else
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    postOffice = new PostOffice(netname, rely, 10, txQueue, linkConfig);
+#endif
+}
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// PrintUsage
+// 	Print what each thread still around has used, and (for user
+//	programs) what each program has used, counting its threads that
+//	have finished.  Called at Halt with -stats.
+//----------------------------------------------------------------------
+void
+PrintUsage()
+{
+    char who[64];
+
+    printf("\nUsage by thread:\n");
+    for (int i = 0; i < MAX_THREAD; i++) {
+	Thread *t = systemThreads[i].getThreadPtr();
+	if (systemThreads[i].getAllocated() && t != NULL) {
+	    sprintf(who, "Thread %d \"%.40s\"", i, t->getName());
+	    t->usage.Print(who);
+	}
+    }
+#ifdef USER_PROGRAM
+    printf("\nUsage by program:\n");
+    PrintProgramUsage();
 #endif
 }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 //----------------------------------------------------------------------
 // Cleanup
@@ -184,7 +359,23 @@ void
 Cleanup()
 {
     printf("\nCleaning up...\n");
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (trace != NULL) {
+	printf("Trace: %d events\n", trace->Count());
+	delete trace;			// writes out the rest
+	trace = NULL;
+    }
+    if (replay != NULL) {
+	delete replay;			// writes out (or checks) the end
+	replay = NULL;
+    }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 #ifdef NETWORK
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (cluster != NULL)
+	delete cluster;		// and every machine's post office
+    else
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     delete postOffice;
 #endif
 
@@ -204,5 +395,5 @@ Cleanup()
     delete scheduler;
     delete interrupt;
 
-    Exit(0);
+    Exit(exitStatus);
 }
@@ -19,7 +19,7 @@
 
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 #define TIME_SLICE 40
-#define MAX_THREAD 128
+#define MAX_THREAD 512
 extern SystemThreads systemThreads[MAX_THREAD];
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
@@ -36,6 +36,15 @@ extern Scheduler *scheduler;			// the ready list
 extern Interrupt *interrupt;			// interrupt status
 extern Statistics *stats;			// performance metrics
 extern Timer *timer;				// the hardware alarm clock
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+extern bool showUsage;				// -stats: report usage at Halt
+extern void PrintUsage();			// usage by thread and program
+extern int exitStatus;				// what Nachos exits with
+
+#include "trace.h"				// the event trace, if -trace
+#include "replay.h"				// -record and -replay
+#include "synch.h"				// -lockstat
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 #ifdef USER_PROGRAM
 #include "machine.h"
@@ -55,6 +64,10 @@ extern SynchDisk   *synchDisk;
 #ifdef NETWORK
 #include "post.h"
 extern PostOffice* postOffice;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#include "cluster.h"
+extern Cluster *cluster;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 #endif
 
 #endif // SYSTEM_H
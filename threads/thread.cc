@@ -44,7 +44,7 @@ Thread::Thread(char* threadName)
     threadID = allocateThreadID();
     if(threadID == -1)
     {
-        printf("At most 128 threads at a time!\n");
+        LOG(LogError, "At most %d threads at a time!\n", MAX_THREAD);
         return;
     }
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
@@ -52,6 +52,9 @@ Thread::Thread(char* threadName)
     stackTop = NULL;
     stack = NULL;
     status = JUST_CREATED;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    ioFile = -1;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 #ifdef USER_PROGRAM
     space = NULL;
@@ -81,6 +84,10 @@ Thread::~Thread()
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     systemThreads[threadID].setAllocated(0);
     systemThreads[threadID].setThreadPtr(NULL);
+#ifdef USER_PROGRAM
+    if (space != NULL)			// the program keeps our share
+	space->usage.Add(&usage);
+#endif
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 }
@@ -39,6 +39,9 @@
 
 #include "copyright.h"
 #include "utility.h"
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#include "stats.h"
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 #ifdef USER_PROGRAM
 #include "machine.h"
@@ -100,6 +103,9 @@ class Thread {
     void CheckOverflow();   			// Check if thread has
 						// overflowed its stack
     void setStatus(ThreadStatus st) { status = st; }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    ThreadStatus getStatus() { return status; }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     char* getName() { return (name); }
     void Print() { printf("%s, ", name); }
 
@@ -145,6 +151,11 @@ class Thread {
     void MultiQueueYield(int priority);
     void MultiQueueSleep();
 
+    UsageStats usage;		// what this thread has used so far
+    int ioFile;			// header sector of the file whose
+				// sectors we're reading or writing,
+				// -1 if none (for -diskstats)
+
     void timeSliceMinus(int arg) { timeSlice -= arg; }
     void timeSlicePlus(int arg) { timeSlice += arg; }
     int getTimeSlice() { return timeSlice; }
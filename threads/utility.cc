@@ -22,6 +22,9 @@
 #endif
 
 static char *enableFlags = NULL; // controls which DEBUG messages are printed 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+int logLevel = LogVerbose;	// print every LOG message, unless -log
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 //----------------------------------------------------------------------
 // DebugInit
@@ -40,6 +43,9 @@ DebugInit(char *flagList)
     enableFlags = flagList;
 }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#ifndef NO_DEBUG		// else DebugIsEnabled and DEBUG are macros
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 //----------------------------------------------------------------------
 // DebugIsEnabled
 //      Return TRUE if DEBUG messages with "flag" are to be printed.
@@ -73,3 +79,6 @@ DEBUG(char flag, char *format, ...)
 	fflush(stdout);
     }
 }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#endif // NO_DEBUG
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
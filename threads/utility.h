@@ -16,6 +16,15 @@
 //   	'a' -- address spaces (USER_PROGRAM)
 //   	'n' -- network emulation (NETWORK)
 //
+//	Compiling with -DNO_DEBUG (as "make fast" does) turns DEBUG and
+//	DebugIsEnabled into constants, so the tests and the calls vanish
+//	from the hot paths of the machine emulation.
+//
+//	LOG is for the messages the kernel prints as it goes ("Syscall:
+//	Open file", "Page fault at ...").  Each has a level; those above
+//	the level given with -log are not printed, and those above
+//	LOG_MAX are not even compiled in.
+//
 // Copyright (c) 1992-1993 The Regents of the University of California.
 // All rights reserved.  See copyright.h for copyright notice and limitation 
 // of liability and disclaimer of warranty provisions.
@@ -60,10 +69,42 @@ typedef void (*VoidNoArgFunctionPtr)();
 
 extern void DebugInit(char* flags);	// enable printing debug messages
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#ifndef NO_DEBUG
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 extern bool DebugIsEnabled(char flag); 	// Is this debug flag enabled?
 
 extern void DEBUG (char flag, char* format, ...);  	// Print debug message 
 							// if flag is enabled
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#else
+// Never enabled.  The printf is never called, but keeps the compiler
+// checking the format, and using the variables only DEBUG prints.
+#define DebugIsEnabled(flag)	FALSE
+#define DEBUG(flag, ...)	do { if (0) printf(__VA_ARGS__); } while (0)
+#endif
+
+// Log levels, least chatty first
+
+enum LogLevel {
+    LogError,			// something went wrong
+    LogInfo,			// what the kernel is doing: system calls,
+				//	files created, programs exiting
+    LogVerbose			// detail: each page allocated or loaded
+};
+
+#ifndef LOG_MAX
+#define LOG_MAX	LogVerbose	// highest level compiled in
+#endif
+
+extern int logLevel;		// highest level printed; set by -log
+
+#define LOG(level, ...)							      \
+    do {								      \
+	if ((level) <= LOG_MAX && (level) <= logLevel)			      \
+	    printf(__VA_ARGS__);					      \
+    } while (0)
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 //----------------------------------------------------------------------
 // ASSERT
@@ -19,10 +19,15 @@
 #include "system.h"
 #include "addrspace.h"
 #include "noff.h"
+#include "fdtable.h"
 #ifdef HOST_SPARC
 #include <strings.h>
 #endif
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+static AddrSpace *allSpaces = NULL;	// every address space, newest first
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 //----------------------------------------------------------------------
 // SwapHeader
 // 	Do little endian to big endian conversion on the bytes in the
@@ -45,6 +50,66 @@ SwapHeader (NoffHeader *noffH)
 	noffH->uninitData.inFileAddr = WordToHost(noffH->uninitData.inFileAddr);
 }
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// LoadSegment
+// 	Copy a NOFF segment from "executable" straight into the physical
+//	frames that back it.  The segment is split at page boundaries,
+//	so each ReadAt covers at most one page instead of one byte.
+//
+//	"pageTable" -- the translation for the address space being loaded
+//	"seg" -- the code or initialized data segment to copy in
+//	"shared" -- if not NULL, pages marked here already hold their
+//		contents (a text page borrowed from another address space)
+//		and are skipped
+//----------------------------------------------------------------------
+
+static void
+LoadSegment(OpenFile *executable, TranslationEntry *pageTable, Segment *seg,
+		bool *shared)
+{
+    int virtAddr = seg->virtualAddr;
+    int pos = seg->inFileAddr;
+    int left = seg->size;
+
+    while (left > 0) {
+        int vpn = virtAddr / PageSize;
+        int offset = virtAddr % PageSize;
+        int chunk = min(PageSize - offset, left);
+        int physAddr = pageTable[vpn].physicalPage * PageSize + offset;
+
+        if (shared == NULL || !shared[vpn])
+            executable->ReadAt(&(machine->mainMemory[physAddr]), chunk, pos);
+        virtAddr += chunk;
+        pos += chunk;
+        left -= chunk;
+    }
+}
+
+//----------------------------------------------------------------------
+// TextPageAddr
+// 	Return the offset in the executable of virtual page "vpn" if the
+//	whole page is code (and so may be shared), -1 otherwise.
+//
+//	A page that lies entirely inside the code segment is never
+//	written, so every address space running the same executable can
+//	map one copy of it read-only; the machine remembers which frame
+//	holds it, by executable (header sector) and file offset, until
+//	the last address space mapping it lets go.
+//----------------------------------------------------------------------
+
+static int
+TextPageAddr(NoffHeader *noffH, int vpn)
+{
+    int start = vpn * PageSize;
+
+    if (noffH->code.size <= 0 || start < noffH->code.virtualAddr
+    		|| start + PageSize > noffH->code.virtualAddr + noffH->code.size)
+        return -1;
+    return noffH->code.inFileAddr + start - noffH->code.virtualAddr;
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 //----------------------------------------------------------------------
 // AddrSpace::AddrSpace
 // 	Create an address space to run a user program.
@@ -79,13 +144,17 @@ AddrSpace::AddrSpace(OpenFile *executable, char* filename)
     numPages = divRoundUp(size, PageSize);
     size = numPages * PageSize;
 
-    ASSERT(numPages <= NumPhysPages);		// check we're not trying
+    ASSERT(numPages <= (unsigned) NumPhysPages);	// check we're not trying
 						// to run anything too big --
 						// at least until we have
 						// virtual memory
 
     DEBUG('a', "Initializing address space, num pages %d, size %d\n",
 					numPages, size);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    int execId = executable->HeaderSector();
+    bool *shared = new bool[numPages];
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 // first, set up the translation
     pageTable = new TranslationEntry[numPages];
     for (i = 0; i < numPages; i++) {
@@ -93,20 +162,33 @@ AddrSpace::AddrSpace(OpenFile *executable, char* filename)
 
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 				//pageTable[i].physicalPage = i;
-				pageTable[i].physicalPage = machine->memoryManagement->Find();
-				ASSERT(pageTable[i].physicalPage != -1);
-				printf("Allocating physicalPage[%d] for pageTable[%d]...\n", pageTable[i].physicalPage, i);
+				int fileAddr = TextPageAddr(&noffH, i);
+				int frame = (fileAddr == -1) ? -1 : machine->FindTextFrame(execId, fileAddr);
+				shared[i] = (frame != -1);
+				if (shared[i]) {
+						machine->ShareFrame(frame);
+						LOG(LogVerbose, "Sharing physicalPage[%d] for pageTable[%d]...\n", frame, i);
+				} else {
+						frame = machine->memoryManagement->Find();
+						ASSERT(frame != -1);
+						bzero(&(machine->mainMemory[frame * PageSize]), PageSize);
+						machine->frameRefs[frame] = 1;
+						if (fileAddr != -1)
+								machine->SetTextFrame(frame, execId, fileAddr);
+						LOG(LogVerbose, "Allocating physicalPage[%d] for pageTable[%d]...\n", frame, i);
+				}
+				pageTable[i].physicalPage = frame;
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 				pageTable[i].valid = TRUE;
 				pageTable[i].use = FALSE;
 				pageTable[i].dirty = FALSE;
-				pageTable[i].readOnly = FALSE;  // if the code segment was entirely on
-					// a separate page, we could set its
-					// pages to be read-only
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+				pageTable[i].readOnly = (fileAddr != -1);	// whole-page text
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     }
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
-				printf("Memory Usage: %f\n\n", machine->memoryManagement->bitRate());
+				LOG(LogVerbose, "Memory Usage: %f\n\n", machine->memoryManagement->bitRate());
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 // zero out the entire address space, to zero the unitialized data segment
@@ -118,14 +200,7 @@ AddrSpace::AddrSpace(OpenFile *executable, char* filename)
         DEBUG('a', "Initializing code segment, at 0x%x, size %d\n",
 			noffH.code.virtualAddr, noffH.code.size);
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
-				int pos = noffH.code.inFileAddr;
-
-				for(int i = 0; i < noffH.code.size; i ++) {
-						int currentVpn = (noffH.code.virtualAddr + i) / PageSize;
-						int currentOffset = (noffH.code.virtualAddr + i) % PageSize;
-						int physAddr = pageTable[currentVpn].physicalPage * PageSize + currentOffset;
-						executable->ReadAt(&(machine->mainMemory[physAddr]), 1, pos ++);
-				}
+				LoadSegment(executable, pageTable, &noffH.code, shared);
         //executable->ReadAt(&(machine->mainMemory[noffH.code.virtualAddr]),
 			//noffH.code.size, noffH.code.inFileAddr);
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
@@ -134,17 +209,23 @@ AddrSpace::AddrSpace(OpenFile *executable, char* filename)
         DEBUG('a', "Initializing data segment, at 0x%x, size %d\n",
 			noffH.initData.virtualAddr, noffH.initData.size);
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
-				int pos = noffH.initData.inFileAddr;
-				for(int i = 0; i < noffH.initData.size; i ++) {
-						int currentVpn = (noffH.initData.virtualAddr + i) / PageSize;
-						int currentOffset = (noffH.initData.virtualAddr + i) % PageSize;
-						int physAddr = pageTable[currentVpn].physicalPage * PageSize + currentOffset;
-						executable->ReadAt(&(machine->mainMemory[physAddr]), 1, pos ++);
-				}
+				LoadSegment(executable, pageTable, &noffH.initData, NULL);
         //executable->ReadAt(&(machine->mainMemory[noffH.initData.virtualAddr]),
 			//noffH.initData.size, noffH.initData.inFileAddr);
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    delete [] shared;
+    fdTable = new FdTable;	// Exec replaces this with the parent's
+
+    name = new char[strlen(filename) + 1];
+    strcpy(name, filename);
+    nextSpace = allSpaces;
+    allSpaces = this;
+    profile = NULL;
+    if (profileInterval > 0)
+	profile = new Profile(filename, numPages * PageSize);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 }
 
 // for exercise 6-7, challenge 2:
@@ -228,19 +309,36 @@ AddrSpace::AddrSpace(OpenFile *executable, char* filename)
 
 //----------------------------------------------------------------------
 // AddrSpace::~AddrSpace
-// 	Dealloate an address space.  Nothing for now!
+// 	Dealloate an address space: give back its frames and close its
+//	open files.
 //----------------------------------------------------------------------
 
 AddrSpace::~AddrSpace()
 {
-   delete pageTable;
-	 for (int i = 0; i < machine->pageTableSize; i++) {
-				 int physicalPage = machine->pageTable[i].physicalPage;
-				 if(machine->memoryManagement->Test(physicalPage)) {
-						 machine->memoryManagement->Clear(physicalPage);
-						 printf("Clearing physicalPage[%d]...\n", physicalPage);
-				}
+	 for (int i = 0; i < numPages; i++) {
+				 if (!pageTable[i].valid)
+						 continue;
+				 int physicalPage = pageTable[i].physicalPage;
+				 if(machine->ReleaseFrame(physicalPage))
+						 LOG(LogVerbose, "Clearing physicalPage[%d]...\n", physicalPage);
+				 pageTable[i].valid = FALSE;
 	 }
+	 if (machine->pageTable == pageTable)
+			 machine->FlushTranslateMemo();
+   delete [] pageTable;
+   delete fdTable;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+   for (AddrSpace **p = &allSpaces; *p != NULL; p = &(*p)->nextSpace)
+       if (*p == this) {
+           *p = nextSpace;
+           break;
+       }
+   delete [] name;
+   if (profile != NULL) {
+       profile->Print();
+       delete profile;
+   }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 }
 
 //----------------------------------------------------------------------
@@ -307,6 +405,9 @@ void AddrSpace::RestoreState()
 {
     machine->pageTable = pageTable;
     machine->pageTableSize = numPages;
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    machine->FlushTranslateMemo();
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 }
 
 // L6
@@ -318,5 +419,76 @@ void AddrSpace::AddrSpaceCopy(AddrSpace* space) {
 		//pageTable = space->getPageTable();
 		for(int i = 0; i < numPages; i ++)
 				pageTable[i] = space->pageTable[i];
+		if (machine->pageTable == pageTable)
+				machine->FlushTranslateMemo();
+}
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+//----------------------------------------------------------------------
+// AddrSpace::TotalUsage
+// 	Total up the resources used by the threads of this program: those
+//	that have finished left their usage here when they were deleted;
+//	the others are found in the thread table.
+//
+//	"total" -- set to the program's usage
+//----------------------------------------------------------------------
+
+void
+AddrSpace::TotalUsage(UsageStats *total)
+{
+    *total = usage;
+    for (int i = 0; i < MAX_THREAD; i++) {
+	Thread *t = systemThreads[i].getThreadPtr();
+	if (systemThreads[i].getAllocated() && t != NULL && t->space == this)
+	    total->Add(&t->usage);
+    }
+}
+
+//----------------------------------------------------------------------
+// PrintProgramUsage
+// 	Print the usage of every user program run so far, oldest first.
+//----------------------------------------------------------------------
+
+static void
+PrintSpaceUsage(AddrSpace *space)
+{
+    UsageStats total;
+    char who[64];
+
+    if (space == NULL)
+	return;
+    PrintSpaceUsage(space->nextSpace);
+    space->TotalUsage(&total);
+    sprintf(who, "Program \"%.40s\"", space->name);
+    total.Print(who);
+}
+
+void
+PrintProgramUsage()
+{
+    PrintSpaceUsage(allSpaces);
+}
+
+//----------------------------------------------------------------------
+// PrintProgramProfiles
+// 	Print the profile of every user program still around, oldest
+//	first.  (Those already gone printed theirs as they went.)
+//----------------------------------------------------------------------
+
+static void
+PrintSpaceProfile(AddrSpace *space)
+{
+    if (space == NULL)
+	return;
+    PrintSpaceProfile(space->nextSpace);
+    if (space->profile != NULL)
+	space->profile->Print();
+}
+
+void
+PrintProgramProfiles()
+{
+    PrintSpaceProfile(allSpaces);
 }
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
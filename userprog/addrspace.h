@@ -15,6 +15,12 @@
 
 #include "copyright.h"
 #include "filesys.h"
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+#include "stats.h"
+#include "profile.h"
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+class FdTable;
 
 #define UserStackSize		1024 	// increase this as necessary!
 
@@ -44,6 +50,24 @@ public:
 					// for now!
     unsigned int numPages;		// Number of pages in the virtual
 					// address space
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    FdTable *fdTable;			// Open files, indexed by OpenFileId
+
+    UsageStats usage;			// What the program's threads that
+					// have finished used
+    void TotalUsage(UsageStats *total);	// Add up "usage" and what the
+					// threads still running have used
+    char *name;				// The program's file name
+    AddrSpace *nextSpace;		// Every address space, for the
+					// usage report
+    Profile *profile;			// Where the program spends its
+					// time, if -prof; else NULL
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 };
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+extern void PrintProgramUsage();	// Usage of every program (-stats)
+extern void PrintProgramProfiles();	// Profile of every program (-prof)
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
 #endif // ADDRSPACE_H
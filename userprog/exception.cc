@@ -27,6 +27,7 @@
 #include "filehdr.h"
 #include "directory.h"
 #include "malloc.h"
+#include "fdtable.h"
 
 
 extern void execFunc(int arg), forkFunc(int arg);
@@ -112,8 +113,193 @@ int LRU() {
     //printf("Replacing TLB[%d]...\n", pos);
     return pos;
 }
+
+//----------------------------------------------------------------------
+// Copying syscall arguments
+// 	The kernel moves user buffers a page at a time: each page is
+//	translated once and then copied with bcopy, instead of doing a
+//	ReadMem/WriteMem (and a Translate) per byte.  A TLB miss or page
+//	fault in the middle of a copy is serviced through the usual
+//	exception path and the page is translated again.
+//
+//	All routines stop at the first address that cannot be mapped.
+//----------------------------------------------------------------------
+
+#define MaxExecNameLen	128	// longest program name Exec copies in
+
+static int
+UserPhysAddr(int addr, bool writing)
+{
+    int physAddr;
+    ExceptionType exception = machine->Translate(addr, &physAddr, 1, writing);
+
+    if (exception == PageFaultException) {
+        machine->RaiseException(exception, addr);
+        exception = machine->Translate(addr, &physAddr, 1, writing);
+    }
+    if (exception != NoException)
+        return -1;
+    return physAddr;
+}
+
+// Copy "size" bytes at user address "addr" into "into"; returns the
+// number of bytes copied.
+static int
+CopyFromUser(int addr, char *into, int size)
+{
+    int done = 0;
+
+    while (done < size) {
+        int physAddr = UserPhysAddr(addr + done, FALSE);
+        if (physAddr == -1)
+            break;
+        int chunk = min(PageSize - (addr + done) % PageSize, size - done);
+        bcopy(&(machine->mainMemory[physAddr]), into + done, chunk);
+        done += chunk;
+    }
+    return done;
+}
+
+// Copy "size" bytes from "from" to user address "addr"; returns the
+// number of bytes copied.
+static int
+CopyToUser(int addr, char *from, int size)
+{
+    int done = 0;
+
+    while (done < size) {
+        int physAddr = UserPhysAddr(addr + done, TRUE);
+        if (physAddr == -1)
+            break;
+        int chunk = min(PageSize - (addr + done) % PageSize, size - done);
+        bcopy(from + done, &(machine->mainMemory[physAddr]), chunk);
+        done += chunk;
+    }
+    return done;
+}
+
+// Copy the null-terminated string at user address "addr" into "into",
+// which holds "maxLen" bytes including the terminator.  Returns the
+// string length, or -1 if the string is too long or not all mapped.
+static int
+CopyStringFromUser(int addr, char *into, int maxLen)
+{
+    int done = 0;
+
+    while (done < maxLen) {
+        int physAddr = UserPhysAddr(addr + done, FALSE);
+        if (physAddr == -1)
+            return -1;
+        int chunk = min(PageSize - (addr + done) % PageSize, maxLen - done);
+        char *src = &(machine->mainMemory[physAddr]);
+        char *end = (char *) memchr(src, '\0', chunk);
+        if (end != NULL) {
+            bcopy(src, into + done, end - src + 1);
+            return done + (end - src);
+        }
+        bcopy(src, into + done, chunk);
+        done += chunk;
+    }
+    into[maxLen - 1] = '\0';
+    return -1;
+}
+
+//----------------------------------------------------------------------
+// ReadIntoUser, WriteFromUser
+// 	Move "size" bytes between "handle" and user address "buffer", a
+//	page at a time through the PageSize kernel buffer "kbuf" (so a
+//	vectored call reuses one buffer for every piece).  "position" is
+//	the file offset for PRead/PWrite, or -1 to use the seek position.
+//
+//	Returns the # of bytes moved, or -1 if the handle can't do it.
+//----------------------------------------------------------------------
+
+static int
+ReadIntoUser(OpenHandle *handle, int buffer, int size, int position,
+		char *kbuf)
+{
+    int done = 0;
+
+    while (done < size) {
+        int chunk = min(PageSize, size - done);
+        int got = (position == -1) ? handle->Read(kbuf, chunk)
+                                   : handle->ReadAt(kbuf, chunk, position + done);
+        if (got == -1)
+            return -1;
+        int copied = CopyToUser(buffer + done, kbuf, got);
+        done += copied;
+        // a pipe or the console returns whatever it has now
+        if (copied < chunk || handle->getType() == PipeReadHandle
+        		|| handle->getType() == ConsoleHandle)
+            break;
+    }
+    return done;
+}
+
+static int
+WriteFromUser(OpenHandle *handle, int buffer, int size, int position,
+		char *kbuf)
+{
+    int done = 0;
+
+    while (done < size) {
+        int chunk = CopyFromUser(buffer + done, kbuf, min(PageSize, size - done));
+        if (chunk == 0)
+            break;
+        int written = (position == -1) ? handle->Write(kbuf, chunk)
+                                       : handle->WriteAt(kbuf, chunk, position + done);
+        if (written == -1)
+            return -1;
+        done += written;
+        if (written < chunk)
+            break;
+    }
+    return done;
+}
+
+//----------------------------------------------------------------------
+// VectorIO
+// 	Carry out ReadV ("writing" FALSE) or WriteV on the "count" IoVecs
+//	at user address "iov" as a single operation.
+//----------------------------------------------------------------------
+
+static int
+VectorIO(OpenHandle *handle, int iov, int count, bool writing)
+{
+    int vec[2 * MaxIoVecs];		// base, len pairs as the user laid them out
+    int size = count * 2 * sizeof(int);
+    char *kbuf;
+    int total = 0;
+
+    if (count < 0 || count > MaxIoVecs || CopyFromUser(iov, (char *)vec, size) < size)
+        return -1;
+    kbuf = new char[PageSize];
+    for (int i = 0; i < count; i++) {
+        int base = WordToHost(vec[2 * i]);
+        int len = WordToHost(vec[2 * i + 1]);
+        int n = writing ? WriteFromUser(handle, base, len, -1, kbuf)
+                        : ReadIntoUser(handle, base, len, -1, kbuf);
+        if (n == -1) {
+            total = -1;
+            break;
+        }
+        total += n;
+        if (n < len)
+            break;
+    }
+    delete [] kbuf;
+    return total;
+}
+
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
+// What SC_Exec hands to the new thread
+class ExecArgs {
+  public:
+    char *name;			// program to run
+    FdTable *fdTable;		// descriptors inherited from the parent
+};
+
 class threadInfo {
   public:
     AddrSpace *space;
@@ -125,6 +311,13 @@ ExceptionHandler(ExceptionType which)
 {
     int type = machine->ReadRegister(2);
 
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if ((which == SyscallException) && (type >= 0) && (type < NumSyscallCodes))
+        currentThread->usage.numSyscalls[type]++;
+    if (which == SyscallException)
+        TRACE(TraceSyscallEnter, type, 0);
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
     if ((which == SyscallException) && (type == SC_Halt)) {
         DEBUG('a', "Shutdown, initiated by user program.\n");
    	    interrupt->Halt();
@@ -134,128 +327,127 @@ ExceptionHandler(ExceptionType which)
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     else if((which == SyscallException) && (type == SC_Create)) {
         int address = machine->ReadRegister(4);
-        char* name = new char[FileNameMaxLen + 1];
-        int pos = 0;
-        int data;
-
-        while(true) {
-            machine->ReadMem(address + pos, 1, &data);
-            if(data == 0) {
-                name[pos] = '\0';
-                break;
-            }
-            name[pos] = char(data);
-            pos ++;
-        }
+        char name[FileNameMaxLen + 1];
 
-        printf("Syscall: Create file: %s\n", name);
-        fileSystem->Create(name, MaxFileSize);
+        if(CopyStringFromUser(address, name, FileNameMaxLen + 1) == -1)
+            LOG(LogError, "Syscall: Create: bad file name\n");
+        else {
+            LOG(LogInfo, "Syscall: Create file: %s\n", name);
+            fileSystem->Create(name, MaxFileSize);
+        }
         machine->PCAdvance();
     }
     else if((which == SyscallException) && (type == SC_Open)) {
         int address = machine->ReadRegister(4);
         char name[FileNameMaxLen + 1];
-        int pos = 0;
-        int data;
-
-        while(true) {
-            machine->ReadMem(address + pos, 1, &data);
-            if(data == 0) {
-                name[pos] = '\0';
-                break;
+        int fd = -1;
+
+        if(CopyStringFromUser(address, name, FileNameMaxLen + 1) == -1)
+            LOG(LogError, "Syscall: Open: bad file name\n");
+        else {
+            LOG(LogInfo, "Syscall: Open file: %s\n", name);
+            OpenFile *openFile = fileSystem->Open(name);
+            if(openFile != NULL) {
+                OpenHandle *handle = new OpenHandle(FileHandle, openFile);
+                fd = currentThread->space->fdTable->Add(handle);
+                if(fd == -1)  // table full
+                    delete handle;
             }
-            name[pos ++] = char(data);
         }
-
-        printf("Syscall: Open file: %s\n", name);
-        OpenFile *openFile = fileSystem->Open(name);
-        machine->WriteRegister(2, int(openFile));
+        machine->WriteRegister(2, fd);
         machine->PCAdvance();
     }
     else if((which == SyscallException) && (type == SC_Close)) {
         int fd = machine->ReadRegister(4);
-        OpenFile *openFile = (OpenFile*)fd;
-        printf("Syscall: Close file\n");
-        delete openFile;
+        LOG(LogInfo, "Syscall: Close file\n");
+        currentThread->space->fdTable->Close(fd);
         machine->PCAdvance();
     }
-    else if((which == SyscallException) && (type == SC_Read)) {
+    else if((which == SyscallException) && (type == SC_Read || type == SC_PRead)) {
 
         int buffer = machine->ReadRegister(4);
         int size = machine->ReadRegister(5);
-        int fd = machine->ReadRegister(6);
-        OpenFile *openFile = (OpenFile*)fd;
-        char into[size];
-        int ret;
-
-        if(fd == 0) { // for L7 std input
-            for(int i = 0; i < size; i ++)
-                into[i] = getchar();
-            ret = size;
+        int position = (type == SC_PRead) ? machine->ReadRegister(6) : -1;
+        int fd = machine->ReadRegister((type == SC_PRead) ? 7 : 6);
+        OpenHandle *handle = currentThread->space->fdTable->Lookup(fd);
+        int ret = -1;
+
+        if(handle != NULL && !(type == SC_PRead && position < 0)) {
+            if(handle->getType() == FileHandle) // L6
+                LOG(LogInfo, "Syscall: Read file\n");
+            // char *into: a page of kernel buffer, refilled until done
+            char *into = new char[PageSize];
+            ret = ReadIntoUser(handle, buffer, size, position, into);
+            delete [] into;
         }
-        else { // L6
-            // char *into: the buffer to contain the data to be read from disk
-            ret = openFile->Read(into, size);
-            printf("Syscall: Read file\n");
-        }
-
-        for(int i = 0; i < ret; i ++) {
-            // int addr: the virtual addr to write to
-            // int size: the number of bytes to be written
-            // int value: the data to be written
-            machine->WriteMem(buffer + i, 1, int(into[i]));
-        }
-
 
         machine->WriteRegister(2, ret);
         machine->PCAdvance();
     }
-    else if((which == SyscallException) && (type == SC_Write)) {
+    else if((which == SyscallException) && (type == SC_Write || type == SC_PWrite)) {
 
         int buffer = machine->ReadRegister(4);
         int size = machine->ReadRegister(5);
-        int fd = machine->ReadRegister(6);
-
-        char from[size];
-        int data;
-        int ret;
-
-        for(int i = 0; i < size; i ++) { // get the data to be written
-            // int addr: the virtual addr to read from
-            // int size: the number of bytes to read
-            // int *value: the place to write the result
-            machine->ReadMem(buffer + i, 1, &data);
-            from[i] = char(data);
+        int position = (type == SC_PWrite) ? machine->ReadRegister(6) : -1;
+        int fd = machine->ReadRegister((type == SC_PWrite) ? 7 : 6);
+        OpenHandle *handle = currentThread->space->fdTable->Lookup(fd);
+        int ret = -1;
+
+        if(handle != NULL && !(type == SC_PWrite && position < 0)) {
+            if(handle->getType() == FileHandle)
+                LOG(LogInfo, "Syscall: Write file\n");
+            // char *from: a page of kernel buffer, refilled until done
+            char *from = new char[PageSize];
+            ret = WriteFromUser(handle, buffer, size, position, from);
+            delete [] from;
         }
 
-        if(fd == 1) { // for L7 std output
-            for(int i = 0; i < size; i ++)
-              putchar(from[i]);
-        }
-        else { // else write to file
-            printf("Syscall: Write file\n");
-            OpenFile *openFile = (OpenFile*)fd;
-            // char *from: the buffer containing the data to be written to disk
-            ret = openFile->Write(from, size);
-        }
+        machine->WriteRegister(2, ret);
+        machine->PCAdvance();
+    }
+    else if((which == SyscallException) && (type == SC_ReadV || type == SC_WriteV)) {
+        int iov = machine->ReadRegister(4);
+        int count = machine->ReadRegister(5);
+        int fd = machine->ReadRegister(6);
+        OpenHandle *handle = currentThread->space->fdTable->Lookup(fd);
+        int ret = -1;
 
+        if(handle != NULL) {
+            if(handle->getType() == FileHandle)
+                LOG(LogInfo, "Syscall: %s file\n", (type == SC_ReadV) ? "ReadV" : "WriteV");
+            ret = VectorIO(handle, iov, count, type == SC_WriteV);
+        }
         machine->WriteRegister(2, ret);
         machine->PCAdvance();
     }
 
     else if((which == SyscallException) && (type == SC_Exec)) {
         int address = machine->ReadRegister(4);
-        Thread* newThread = new Thread("new thread");
-
-        printf("Syscall: Execute new thread\n");
-        newThread->Fork(execFunc, address);
-
-        machine->WriteRegister(2, newThread->getThreadID());
+        // copy the name now, while the caller's pages are mapped;
+        // execFunc keeps it as the new thread's userProgFilename
+        char *name = new char[MaxExecNameLen + 1];
+
+        if(CopyStringFromUser(address, name, MaxExecNameLen + 1) == -1) {
+            LOG(LogError, "Syscall: Exec: bad program name\n");
+            delete [] name;
+            machine->WriteRegister(2, -1);
+        }
+        else {
+            Thread* newThread = new Thread("new thread");
+            ExecArgs *args = new ExecArgs;
+
+            // the new program inherits our open files
+            args->name = name;
+            args->fdTable = new FdTable(currentThread->space->fdTable);
+            LOG(LogInfo, "Syscall: Execute new thread\n");
+            newThread->Fork(execFunc, int(args));
+            machine->WriteRegister(2, newThread->getThreadID());
+        }
         machine->PCAdvance();
     }
 
     else if((which == SyscallException) && (type == SC_Fork)) {
-        printf("Syscall: Fork new thread\n");
+        LOG(LogInfo, "Syscall: Fork new thread\n");
         int funcPC = machine->ReadRegister(4);
 
         Thread *newThread = new Thread("fork thread");
@@ -267,13 +459,13 @@ ExceptionHandler(ExceptionType which)
     }
 
     else if((which == SyscallException) && (type == SC_Yield)) {
-        printf("Syscall: Yield '%s'\n\n", currentThread->getName());
+        LOG(LogInfo, "Syscall: Yield '%s'\n\n", currentThread->getName());
         machine->PCAdvance();
         currentThread->Yield();
     }
 
     else if((which == SyscallException) && (type == SC_Join)) {
-        printf("Syscall: Join\n\n");
+        LOG(LogInfo, "Syscall: Join\n\n");
         int threadID = machine->ReadRegister(4);
 
         while(systemThreads[threadID].getAllocated())
@@ -290,6 +482,59 @@ ExceptionHandler(ExceptionType which)
         system("ls");
         machine->PCAdvance();
     }
+    else if((which == SyscallException) && (type == SC_Pipe)) {
+        int address = machine->ReadRegister(4);
+        FdTable *fdTable = currentThread->space->fdTable;
+        SynchPipe *pipe = new SynchPipe("user pipe");
+        OpenHandle *readEnd = new OpenHandle(PipeReadHandle, NULL, pipe);
+        OpenHandle *writeEnd = new OpenHandle(PipeWriteHandle, NULL, pipe);
+        int fds[2];
+        int ret = -1;
+
+        LOG(LogInfo, "Syscall: Pipe\n");
+        fds[0] = fdTable->Add(readEnd);
+        fds[1] = fdTable->Add(writeEnd);
+        if(fds[0] != -1 && fds[1] != -1) {
+            int out[2];
+            out[0] = WordToMachine(fds[0]);
+            out[1] = WordToMachine(fds[1]);
+            if(CopyToUser(address, (char *)out, sizeof(out)) == sizeof(out))
+                ret = 0;
+        }
+        if(ret == -1) { // give back what was set up; frees the pipe
+            if(fds[0] != -1)
+                fdTable->Close(fds[0]);
+            else
+                delete readEnd;
+            if(fds[1] != -1)
+                fdTable->Close(fds[1]);
+            else
+                delete writeEnd;
+        }
+        machine->WriteRegister(2, ret);
+        machine->PCAdvance();
+    }
+    else if((which == SyscallException) && (type == SC_GetUsage)) {
+        int who = machine->ReadRegister(4);
+        int address = machine->ReadRegister(5);
+        UsageStats usage;		// copied out word by word, as a Usage
+        int *words = (int *)&usage;
+        int ret = -1;
+
+        ASSERT(sizeof(UsageStats) == sizeof(Usage));
+        if(who == UsageThread || who == UsageProgram) {
+            if(who == UsageThread)
+                usage = currentThread->usage;
+            else
+                currentThread->space->TotalUsage(&usage);
+            for(int i = 0; i < (int) (sizeof(usage) / sizeof(int)); i ++)
+                words[i] = WordToMachine(words[i]);
+            if(CopyToUser(address, (char *)&usage, sizeof(usage)) == sizeof(usage))
+                ret = 0;
+        }
+        machine->WriteRegister(2, ret);
+        machine->PCAdvance();
+    }
 
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
@@ -300,6 +545,9 @@ ExceptionHandler(ExceptionType which)
         if(machine->tlb != NULL) {
 
             //printf("\nTLB MISS!\n");
+            stats->numTlbMisses++;
+            currentThread->usage.numTlbMisses++;
+            TRACE(TraceTlbMiss, machine->registers[BadVAddrReg], 0);
 
             int badVAddr = machine->registers[BadVAddrReg];
             int vpn = (unsigned) badVAddr / PageSize;
@@ -315,7 +563,7 @@ ExceptionHandler(ExceptionType which)
             machine->tlb[pos].physicalPage = machine->pageTable[vpn].physicalPage;
             machine->tlb[pos].use = FALSE;
             machine->tlb[pos].dirty = FALSE;
-            machine->tlb[pos].readOnly = FALSE;
+            machine->tlb[pos].readOnly = machine->pageTable[vpn].readOnly;
         }
         // page table miss, need to load page from disk
         else {
@@ -327,29 +575,42 @@ ExceptionHandler(ExceptionType which)
             int badVAddr = machine->registers[BadVAddrReg];
             int vpn = (unsigned) badVAddr / PageSize;
 
-            printf("========Page fault at VA = 0x%x========\n", machine->registers[BadVAddrReg]);
+            LOG(LogVerbose, "========Page fault at VA = 0x%x========\n", machine->registers[BadVAddrReg]);
+            stats->numPageFaults++;
+            currentThread->usage.numPageFaults++;
+            TRACE(TracePageFault, badVAddr, 0);
 
             // exercise 1-7
             if(machine->invertedPageTable == NULL) {
                 // find a place in mainMemory to load to
                 int pos = machine->memoryManagement->Find();
-                if(pos == -1) { // replace the physical page pointed by pageTable[0];
-                    pos = machine->pageTable[0].physicalPage;
-                    if(machine->pageTable[0].dirty == TRUE) {
+                if(pos == -1) { // replace the first page of ours nobody else maps;
+                                // a shared text frame must stay as it is
+                    unsigned int victim = 0;
+                    while(victim < machine->pageTableSize
+                          && (!machine->pageTable[victim].valid
+                              || machine->frameRefs[machine->pageTable[victim].physicalPage] > 1))
+                        victim ++;
+                    ASSERT(victim < machine->pageTableSize);
+                    pos = machine->pageTable[victim].physicalPage;
+                    if(machine->pageTable[victim].dirty == TRUE)
                          diskFile->WriteAt(&(machine->mainMemory[pos * PageSize]),
-                         PageSize, machine->pageTable[0].virtualPage * PageSize);
-                         machine->pageTable[0].valid = FALSE;
-                    }
+                         PageSize, machine->pageTable[victim].virtualPage * PageSize);
+                    machine->pageTable[victim].valid = FALSE;
+                    machine->ReleaseFrame(pos);     // forget it held text
+                    pos = machine->memoryManagement->Find();
                 }
+                machine->frameRefs[pos] = 1;
 
-                printf("   Loading virtualPage[%d] from disk\n", vpn);
+                LOG(LogVerbose, "   Loading virtualPage[%d] from disk\n", vpn);
                 diskFile->ReadAt(&(machine->mainMemory[pos * PageSize]), PageSize, vpn * PageSize);
                 machine->pageTable[vpn].valid = TRUE;
                 machine->pageTable[vpn].physicalPage = pos;
                 machine->pageTable[vpn].use = FALSE;
                 machine->pageTable[vpn].dirty = FALSE;
                 machine->pageTable[vpn].readOnly = FALSE;
-                printf("   Saved at physicalPage[%d]\n\n", pos);
+                machine->FlushTranslateMemo();
+                LOG(LogVerbose, "   Saved at physicalPage[%d]\n\n", pos);
             }
             // challenge 2 using invertedPageTable
             else {
@@ -363,7 +624,7 @@ ExceptionHandler(ExceptionType which)
                         machine->invertedPageTable[0].valid = FALSE;
                     }
                 }
-                printf("   Loading virtualPage[%d] from disk\n", vpn);
+                LOG(LogVerbose, "   Loading virtualPage[%d] from disk\n", vpn);
                 diskFile->ReadAt(&(machine->mainMemory[pos * PageSize]), PageSize, vpn * PageSize);
                 machine->invertedPageTable[vpn].valid = TRUE;
                 machine->invertedPageTable[vpn].physicalPage = pos;
@@ -371,7 +632,7 @@ ExceptionHandler(ExceptionType which)
                 machine->invertedPageTable[vpn].dirty = FALSE;
                 machine->invertedPageTable[vpn].readOnly = FALSE;
                 machine->invertedPageTable[vpn].threadID = currentThread->getThreadID();
-                printf("   Saved at physicalPage[%d]\n", pos);
+                LOG(LogVerbose, "   Saved at physicalPage[%d]\n", pos);
             }
 
             delete diskFile;
@@ -382,10 +643,14 @@ ExceptionHandler(ExceptionType which)
     else if((which == SyscallException) && (type == SC_Exit)) {
         //printf("\n");
         // for L6
-        printf("Syscall: Exit\n");
+        LOG(LogInfo, "Syscall: Exit\n");
         int status = machine->ReadRegister(4);
-        printf("Program exits with status %d\n", status);
-        printf("\n");
+        LOG(LogInfo, "Program exits with status %d\n", status);
+        LOG(LogInfo, "\n");
+
+        // close whatever the program left open; a pipe writer going
+        // away is what lets its reader see end of file
+        currentThread->space->fdTable->CloseAll();
 
         // for exercise 4-7
         if(machine->invertedPageTable == NULL) {
@@ -393,13 +658,13 @@ ExceptionHandler(ExceptionType which)
             for (int i = 0; i < machine->pageTableSize; i++) {
                 if(machine->pageTable[i].valid == TRUE) {
                     int physicalPage = machine->pageTable[i].physicalPage;
-                    if(machine->memoryManagement->Test(physicalPage)) {
-                        machine->memoryManagement->Clear(physicalPage);
-                        machine->pageTable[i].valid = FALSE;
-                        printf("Clearing physicalPage[%d]...\n", physicalPage);
-                    }
+                    // shared text frames stay until their last user exits
+                    if(machine->ReleaseFrame(physicalPage))
+                        LOG(LogVerbose, "Clearing physicalPage[%d]...\n", physicalPage);
+                    machine->pageTable[i].valid = FALSE;
                 }
             }
+            machine->FlushTranslateMemo();
         }
 
         // for challenge 2
@@ -407,23 +672,23 @@ ExceptionHandler(ExceptionType which)
 
             for(int i = 0; i < NumPhysPages; i ++) {
                 if(machine->invertedPageTable[i].valid) {
-                    printf("PP[%d]: VP[%d], thread %d\n", machine->invertedPageTable[i].physicalPage, machine->invertedPageTable[i].virtualPage, machine->invertedPageTable[i].threadID);
+                    LOG(LogVerbose, "PP[%d]: VP[%d], thread %d\n", machine->invertedPageTable[i].physicalPage, machine->invertedPageTable[i].virtualPage, machine->invertedPageTable[i].threadID);
                 }
             }
-            printf("\n");
+            LOG(LogVerbose, "\n");
             for(int i = 0; i < NumPhysPages; i ++) {
                 if((machine->invertedPageTable[i].threadID == currentThread->getThreadID()) && (machine->invertedPageTable[i].valid == TRUE)) {
                     int physicalPage = machine->invertedPageTable[i].physicalPage;
                     if(machine->memoryManagement->Test(physicalPage)) {
                         machine->memoryManagement->Clear(physicalPage);
                         machine->invertedPageTable[i].valid = FALSE;
-                        printf("Clearing physicalPage[%d] for thread %d...\n", physicalPage, currentThread->getThreadID());
+                        LOG(LogVerbose, "Clearing physicalPage[%d] for thread %d...\n", physicalPage, currentThread->getThreadID());
                     }
                 }
             }
         }
 
-        printf("Program exits. CurrentThread '%s' finished.\n\n", currentThread->getName());
+        LOG(LogInfo, "Program exits. CurrentThread '%s' finished.\n\n", currentThread->getName());
 
         machine->PCAdvance();
         currentThread->Finish();
@@ -431,34 +696,32 @@ ExceptionHandler(ExceptionType which)
     }
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
     else {
-	      printf("Unexpected user mode exception %d %d\n", which, type);
+	      LOG(LogError, "Unexpected user mode exception %d %d\n", which, type);
 	      ASSERT(FALSE);
     }
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+    if (which == SyscallException)	// (Exit and Halt never get here)
+        TRACE(TraceSyscallExit, type, machine->ReadRegister(2));
+/*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 }
 
 
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
-void execFunc(int address) {
-
-    char name[MaxFileSize + 1];
-    int pos = 0;
-    int data;
-    while(true) {
-        machine->ReadMem(address + pos, 1, &data);
-        if(data == 0) {
-            name[pos] = '\0';
-            break;
-        }
-        name[pos ++] = char(data);
-    }
+void execFunc(int arg) {
+
+    ExecArgs *args = (ExecArgs *)arg;	// set up by SC_Exec
+    char *name = args->name;
 
-    printf("New thread's userprog name: %s\n\n", name);
+    LOG(LogInfo, "New thread's userprog name: %s\n\n", name);
     OpenFile *executable = fileSystem->Open(name);
     AddrSpace *space;
     space = new AddrSpace(executable, name);
 
     currentThread->space = space;
     currentThread->userProgFilename = name;
+    delete space->fdTable;
+    space->fdTable = args->fdTable;
+    delete args;
 
     delete executable;
 
@@ -0,0 +1,197 @@
+// fdtable.cc
+//	Routines to manage the open files of a user program.  See
+//	fdtable.h.
+
+#include "copyright.h"
+#include "fdtable.h"
+#include "syscall.h"
+#include "synchconsole.h"
+
+// The console behind ConsoleInput and ConsoleOutput, made on first use
+static SynchConsole *userConsole = NULL;
+
+static SynchConsole *
+UserConsole()
+{
+    if (userConsole == NULL)
+	userConsole = new SynchConsole(NULL, NULL);
+    return userConsole;
+}
+
+//----------------------------------------------------------------------
+// OpenHandle::OpenHandle
+// 	Wrap an open file ("f"), one end of a pipe ("p") or the console.
+//	The handle starts out with a single user.
+//----------------------------------------------------------------------
+
+OpenHandle::OpenHandle(HandleType t, OpenFile *f, SynchPipe *p)
+{
+    type = t;
+    file = f;
+    pipe = p;
+    refs = 1;
+}
+
+//----------------------------------------------------------------------
+// OpenHandle::~OpenHandle
+// 	Close the file, or give up our end of the pipe.
+//----------------------------------------------------------------------
+
+OpenHandle::~OpenHandle()
+{
+    if (type == FileHandle)
+	delete file;
+    else if (type == PipeReadHandle || type == PipeWriteHandle) {
+	if (pipe->CloseEnd(type == PipeWriteHandle))
+	    delete pipe;
+    }
+}
+
+//----------------------------------------------------------------------
+// OpenHandle::Read
+// 	Read up to "numBytes" bytes.  A pipe returns what it has (at
+//	least one byte unless at end of file); the console returns at
+//	most one line.
+//----------------------------------------------------------------------
+
+int
+OpenHandle::Read(char *into, int numBytes)
+{
+    switch (type) {
+      case ConsoleHandle:
+	return UserConsole()->Read(into, numBytes);
+      case FileHandle:
+	return file->Read(into, numBytes);
+      case PipeReadHandle:
+	return pipe->Read(into, numBytes);
+      default:
+	return -1;
+    }
+}
+
+//----------------------------------------------------------------------
+// OpenHandle::Write
+// 	Write "numBytes" bytes; returns the number actually written.
+//----------------------------------------------------------------------
+
+int
+OpenHandle::Write(char *from, int numBytes)
+{
+    switch (type) {
+      case ConsoleHandle:
+	UserConsole()->Write(from, numBytes);
+	return numBytes;
+      case FileHandle:
+	return file->Write(from, numBytes);
+      case PipeWriteHandle:
+	return pipe->Write(from, numBytes);
+      default:
+	return -1;
+    }
+}
+
+//----------------------------------------------------------------------
+// OpenHandle::ReadAt, OpenHandle::WriteAt
+// 	Positional I/O.  Only files have positions; anything else
+//	returns -1.
+//----------------------------------------------------------------------
+
+int
+OpenHandle::ReadAt(char *into, int numBytes, int position)
+{
+    if (type != FileHandle)
+	return -1;
+    return file->ReadAt(into, numBytes, position);
+}
+
+int
+OpenHandle::WriteAt(char *from, int numBytes, int position)
+{
+    if (type != FileHandle)
+	return -1;
+    return file->WriteAt(from, numBytes, position);
+}
+
+//----------------------------------------------------------------------
+// FdTable::FdTable
+// 	A new program starts with only the console open.
+//----------------------------------------------------------------------
+
+FdTable::FdTable()
+{
+    for (int i = 0; i < MaxOpenFiles; i++)
+	table[i] = NULL;
+    table[ConsoleInput] = new OpenHandle(ConsoleHandle);
+    table[ConsoleOutput] = new OpenHandle(ConsoleHandle);
+}
+
+//----------------------------------------------------------------------
+// FdTable::FdTable
+// 	A program started by "parent" (with Exec) sees the same open
+//	files, under the same ids.
+//----------------------------------------------------------------------
+
+FdTable::FdTable(FdTable *parent)
+{
+    for (int i = 0; i < MaxOpenFiles; i++) {
+	table[i] = parent->table[i];
+	if (table[i] != NULL)
+	    table[i]->Ref();
+    }
+}
+
+FdTable::~FdTable()
+{
+    CloseAll();
+}
+
+//----------------------------------------------------------------------
+// FdTable::Add
+// 	Give "handle" the lowest free id.  Returns -1 if the table is
+//	full; the caller still owns the handle then.
+//----------------------------------------------------------------------
+
+int
+FdTable::Add(OpenHandle *handle)
+{
+    for (int i = 0; i < MaxOpenFiles; i++)
+	if (table[i] == NULL) {
+	    table[i] = handle;
+	    return i;
+	}
+    return -1;
+}
+
+OpenHandle *
+FdTable::Lookup(int fd)
+{
+    if (fd < 0 || fd >= MaxOpenFiles)
+	return NULL;
+    return table[fd];
+}
+
+//----------------------------------------------------------------------
+// FdTable::Close
+// 	Free descriptor "fd", closing the file behind it if this was
+//	the last descriptor for it.
+//----------------------------------------------------------------------
+
+bool
+FdTable::Close(int fd)
+{
+    OpenHandle *handle = Lookup(fd);
+
+    if (handle == NULL)
+	return FALSE;
+    table[fd] = NULL;
+    if (handle->Unref())
+	delete handle;
+    return TRUE;
+}
+
+void
+FdTable::CloseAll()
+{
+    for (int i = 0; i < MaxOpenFiles; i++)
+	Close(i);
+}
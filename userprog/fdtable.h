@@ -0,0 +1,62 @@
+// fdtable.h
+//	Data structures for the open files of a user program.
+//
+//	A user program names an open file, a pipe end or the console by
+//	a small integer (an OpenFileId) that indexes the FdTable of its
+//	address space.  Each slot points to an OpenHandle.  A handle can
+//	sit in several tables at once (a program started with Exec gets
+//	its parent's descriptors), so it counts its users and really
+//	closes the file or pipe end when the last one lets go.
+
+#ifndef FDTABLE_H
+#define FDTABLE_H
+
+#include "copyright.h"
+#include "openfile.h"
+#include "synchpipe.h"
+
+#define MaxOpenFiles	16	// descriptors per address space,
+				// including ConsoleInput/ConsoleOutput
+
+enum HandleType { ConsoleHandle, FileHandle, PipeReadHandle, PipeWriteHandle };
+
+class OpenHandle {
+  public:
+    OpenHandle(HandleType t, OpenFile *f = NULL, SynchPipe *p = NULL);
+    ~OpenHandle();			// close the file or pipe end
+
+    int Read(char *into, int numBytes);	// -1 if the handle can't be read
+    int Write(char *from, int numBytes);// -1 if it can't be written
+    int ReadAt(char *into, int numBytes, int position);
+    int WriteAt(char *from, int numBytes, int position);
+					// at an explicit offset, leaving the
+					// seek position alone; files only
+    HandleType getType() { return type; }
+
+    void Ref() { refs++; }		// one more table points here
+    bool Unref() { return --refs == 0; }// TRUE when nobody does
+
+  private:
+    HandleType type;
+    OpenFile *file;			// for FileHandle
+    SynchPipe *pipe;			// for the pipe ends
+    int refs;				// # of descriptors naming this
+};
+
+class FdTable {
+  public:
+    FdTable();				// just the console at ConsoleInput
+					// and ConsoleOutput
+    FdTable(FdTable *parent);		// share every descriptor of parent
+    ~FdTable();				// close whatever is still open
+
+    int Add(OpenHandle *handle);	// lowest free id, -1 if full
+    OpenHandle *Lookup(int fd);		// NULL if fd isn't open
+    bool Close(int fd);			// FALSE if fd isn't open
+    void CloseAll();
+
+  private:
+    OpenHandle *table[MaxOpenFiles];	// NULL for a free slot
+};
+
+#endif // FDTABLE_H
@@ -0,0 +1,497 @@
+// profile.cc
+//	Routines for the sampling profiler of user programs.  See
+//	profile.h.
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#include "copyright.h"
+#include "system.h"
+#include "profile.h"
+
+int profileInterval = 0;		// -prof: user ticks between samples
+static int ticksToSample;		// user ticks until the next sample
+static int stacksFile = -1;		// ProfileStacksFile, once opened
+
+// What we need of the MIPS COFF format (see bin/coff.h, and <syms.h>
+// on a MIPS host): the file header points to the symbolic header, which
+// points to the external symbols and their names.
+
+#define CoffMagic	0x0162		// MIPSELMAGIC
+#define SymbolMagic	0x7009		// magicSym
+#define CoffSymPtr	8		// filehdr.f_symptr
+#define SymExtNames	68		// HDRR.cbSsExtOffset
+#define SymExtCount	88		// HDRR.iextMax
+#define SymExtTable	92		// HDRR.cbExtOffset
+#define ExtSize		16		// sizeof(EXTR)
+#define stProc		6		// symbol types that are functions
+#define stStaticProc	14
+#define scText		1		// storage class of the text segment
+
+// Instructions the stack walk looks for in a function's prologue
+
+#define OpcodeADDIU	9		// addiu sp, sp, -framesize
+#define OpcodeSW	43		// sw ra, offset(sp)
+#define MaxPrologue	16		// instructions to look at
+
+#define MaxFlatLines	40		// functions in the flat profile
+
+//----------------------------------------------------------------------
+// PeekWord
+// 	Read a word of the running program's memory, if it is in main
+//	memory.  Unlike Machine::ReadMem, never causes an exception, so
+//	it is safe to call from the interrupt code.
+//
+//	"addr" -- the virtual address to read
+//	"value" -- where to put the word
+//----------------------------------------------------------------------
+
+static bool
+PeekWord(int addr, int *value)
+{
+    unsigned int vpn = (unsigned) addr / PageSize;
+    int frame = -1;
+
+    if ((addr & 3) != 0)
+	return FALSE;
+    if (machine->invertedPageTable != NULL) {
+	for (int i = 0; i < NumPhysPages; i++) {
+	    TranslationEntry *entry = &machine->invertedPageTable[i];
+	    if (entry->valid && entry->virtualPage == (int) vpn
+			&& entry->threadID == currentThread->getThreadID())
+		frame = entry->physicalPage;
+	}
+    } else if (machine->pageTable != NULL && vpn < machine->pageTableSize
+		&& machine->pageTable[vpn].valid)
+	frame = machine->pageTable[vpn].physicalPage;
+    if (frame == -1)
+	return FALSE;
+
+    *value = WordToHost(*(unsigned int *)
+		&machine->mainMemory[frame * PageSize + (unsigned) addr % PageSize]);
+    return TRUE;
+}
+
+//----------------------------------------------------------------------
+// ProfileTick
+// 	Called from Interrupt::OneTick for each tick of user time, when
+//	profiling.  Every profileInterval ticks, sample the running
+//	program.
+//----------------------------------------------------------------------
+
+void
+ProfileTick(int ticks)
+{
+    ticksToSample -= ticks;
+    if (ticksToSample > 0)
+	return;
+    ticksToSample += profileInterval;
+
+    if (currentThread->space != NULL && currentThread->space->profile != NULL)
+	currentThread->space->profile->Sample();
+}
+
+//----------------------------------------------------------------------
+// Profile::Profile
+// 	Set up an empty profile for a program, and load its symbols.
+//
+//	"programName" -- the NOFF file; the symbols come from
+//		programName.coff, if it is there
+//	"size" -- bytes in the address space
+//----------------------------------------------------------------------
+
+Profile::Profile(char *programName, int size)
+{
+    char *coffName = new char[strlen(programName) + 6];
+
+    name = new char[strlen(programName) + 1];
+    strcpy(name, programName);
+    numSamples = 0;
+
+    numPCs = size / 4;
+    pcCounts = new int[numPCs];
+    for (int i = 0; i < numPCs; i++)
+	pcCounts[i] = 0;
+    for (int i = 0; i < ProfileHashSize; i++)
+	stacks[i] = NULL;
+
+    numSymbols = 0;
+    symbolAddr = NULL;
+    symbolName = NULL;
+    sprintf(coffName, "%s.coff", programName);
+    LoadSymbols(coffName);
+    delete [] coffName;
+}
+
+//----------------------------------------------------------------------
+// Profile::~Profile
+//----------------------------------------------------------------------
+
+Profile::~Profile()
+{
+    for (int i = 0; i < ProfileHashSize; i++)
+	while (stacks[i] != NULL) {
+	    ProfileStack *stack = stacks[i];
+	    stacks[i] = stack->next;
+	    delete stack;
+	}
+    for (int i = 0; i < numSymbols; i++)
+	delete [] symbolName[i];
+    delete [] symbolName;
+    delete [] symbolAddr;
+    delete [] pcCounts;
+    delete [] name;
+}
+
+//----------------------------------------------------------------------
+// Profile::LoadSymbols
+// 	Read the external function symbols out of a COFF file, and sort
+//	them by address.  If the file isn't there, or doesn't look right,
+//	we do without: the profile is then by PC.
+//
+//	"coffName" -- the UNIX file to read
+//----------------------------------------------------------------------
+
+void
+Profile::LoadSymbols(char *coffName)
+{
+    int fd = OpenForReadWrite(coffName, FALSE);
+    int size, symPtr, names, count, table;
+    char *image;
+
+    if (fd < 0)
+	return;
+    Lseek(fd, 0, 2);
+    size = Tell(fd);
+    Lseek(fd, 0, 0);
+    image = new char[size];
+    if (size < 20 || ReadPartial(fd, image, size) != size
+		|| ShortToHost(*(unsigned short *) image) != CoffMagic) {
+	Close(fd);
+	delete [] image;
+	return;
+    }
+    Close(fd);
+
+#define CoffWord(offset)  ((int) WordToHost(*(unsigned int *) &image[offset]))
+
+    symPtr = CoffWord(CoffSymPtr);
+    if (symPtr <= 0 || symPtr + SymExtTable + 4 > size
+		|| ShortToHost(*(unsigned short *) &image[symPtr]) != SymbolMagic) {
+	delete [] image;
+	return;
+    }
+    names = CoffWord(symPtr + SymExtNames);
+    count = CoffWord(symPtr + SymExtCount);
+    table = CoffWord(symPtr + SymExtTable);
+    if (count <= 0 || table + count * ExtSize > size) {
+	delete [] image;
+	return;
+    }
+
+    symbolAddr = new int[count];
+    symbolName = new char *[count];
+    for (int i = 0; i < count; i++) {
+	char *ext = &image[table + i * ExtSize];
+	int nameOffset = names + (int) WordToHost(*(unsigned int *) &ext[4]);
+	int value = (int) WordToHost(*(unsigned int *) &ext[8]);
+	unsigned int bits = WordToHost(*(unsigned int *) &ext[12]);
+	int type = bits & 0x3f, storageClass = (bits >> 6) & 0x1f;
+	int j, len;
+
+	if ((type != stProc && type != stStaticProc) || storageClass != scText
+		|| nameOffset < 0 || nameOffset >= size)
+	    continue;
+
+	// insert, keeping the table sorted by address
+	for (j = numSymbols; j > 0 && symbolAddr[j - 1] > value; j--) {
+	    symbolAddr[j] = symbolAddr[j - 1];
+	    symbolName[j] = symbolName[j - 1];
+	}
+	for (len = 0; nameOffset + len < size && image[nameOffset + len]; len++)
+	    ;
+	symbolAddr[j] = value;
+	symbolName[j] = new char[len + 1];
+	memcpy(symbolName[j], &image[nameOffset], len);
+	symbolName[j][len] = '\0';
+	numSymbols++;
+    }
+#undef CoffWord
+
+    DEBUG('a', "Profile: %d functions in %s\n", numSymbols, coffName);
+    delete [] image;
+}
+
+//----------------------------------------------------------------------
+// Profile::FindSymbol
+// 	Return the index of the function holding "addr": the last one
+//	that starts at or before it.  -1 if there is none.
+//----------------------------------------------------------------------
+
+int
+Profile::FindSymbol(int addr)
+{
+    int low = 0, high = numSymbols - 1;
+
+    if (numSymbols == 0 || addr < symbolAddr[0])
+	return -1;
+    while (low < high) {		// binary search
+	int mid = (low + high + 1) / 2;
+	if (symbolAddr[mid] <= addr)
+	    low = mid;
+	else
+	    high = mid - 1;
+    }
+    return low;
+}
+
+//----------------------------------------------------------------------
+// Profile::Walk
+// 	Find the call stack of the running program.  For each function,
+//	we decode its prologue (up to the PC, if we are still in it) to
+//	find how much it took off the stack pointer, and where it saved
+//	its return address.  A function that hasn't saved it (a leaf, or
+//	one just entered) still has it in RetAddrReg -- which only
+//	holds for the innermost frame.
+//
+//	Stops at a PC outside every function, at a return address we
+//	can't find, and after MaxProfileDepth frames.
+//
+//	"frames" -- set to the start of each function, leaf first
+//----------------------------------------------------------------------
+
+int
+Profile::Walk(int *frames)
+{
+    int pc = machine->ReadRegister(PCReg);
+    int sp = machine->ReadRegister(StackReg);
+    int ra = machine->ReadRegister(RetAddrReg);
+    int depth = 0;
+
+    while (depth < MaxProfileDepth) {
+	int sym = FindSymbol(pc);
+	int frameSize = 0, raOffset = -1;
+	int instr;
+
+	if (sym == -1) {			// we don't know where we are
+	    frames[depth++] = pc;
+	    break;
+	}
+	frames[depth++] = symbolAddr[sym];
+
+	for (int addr = symbolAddr[sym];
+		addr < pc && addr < symbolAddr[sym] + MaxPrologue * 4; addr += 4) {
+	    if (!PeekWord(addr, &instr))
+		break;
+	    int op = (instr >> 26) & 0x3f;
+	    int rs = (instr >> 21) & 0x1f;
+	    int rt = (instr >> 16) & 0x1f;
+	    int imm = (short) (instr & 0xffff);
+
+	    if (op == OpcodeADDIU && rs == StackReg && rt == StackReg && imm < 0)
+		frameSize = -imm;
+	    else if (op == OpcodeSW && rs == StackReg && rt == RetAddrReg)
+		raOffset = imm;
+	}
+
+	if (raOffset != -1) {
+	    if (!PeekWord(sp + raOffset, &ra))
+		break;
+	} else if (depth > 1)			// RetAddrReg is someone else's
+	    break;
+	if (ra <= 0)				// back in __start's caller
+	    break;
+	sp += frameSize;
+	pc = ra - 8;				// the jal, and so in the caller
+    }
+    return depth;
+}
+
+//----------------------------------------------------------------------
+// Profile::Sample
+// 	Record where the running program is: its PC in the histogram, and
+//	its call stack in the stack table.
+//----------------------------------------------------------------------
+
+void
+Profile::Sample()
+{
+    int frames[MaxProfileDepth];
+    unsigned int pc = machine->ReadRegister(PCReg);
+
+    numSamples++;
+    if (pc / 4 < (unsigned) numPCs)
+	pcCounts[pc / 4]++;
+    CountStack(frames, Walk(frames));
+}
+
+//----------------------------------------------------------------------
+// Profile::CountStack
+// 	Count one more sample with this call stack, adding the stack to
+//	the table if it is new.
+//----------------------------------------------------------------------
+
+void
+Profile::CountStack(int *frames, int depth)
+{
+    unsigned int hash = depth;
+    ProfileStack *stack;
+
+    for (int i = 0; i < depth; i++)
+	hash = hash * 31 + frames[i];
+    hash %= ProfileHashSize;
+
+    for (stack = stacks[hash]; stack != NULL; stack = stack->next)
+	if (stack->depth == depth
+		&& !memcmp(stack->frames, frames, depth * sizeof(int))) {
+	    stack->count++;
+	    return;
+	}
+
+    stack = new ProfileStack;
+    stack->count = 1;
+    stack->depth = depth;
+    memcpy(stack->frames, frames, depth * sizeof(int));
+    stack->next = stacks[hash];
+    stacks[hash] = stack;
+}
+
+//----------------------------------------------------------------------
+// Profile::Name
+// 	Return the name for a frame of a call stack: the function's, if
+//	"addr" is where one starts, else the address in hex.
+//
+//	"buf" -- room for the hex, if needed
+//----------------------------------------------------------------------
+
+char *
+Profile::Name(int addr, char *buf)
+{
+    int sym = FindSymbol(addr);
+
+    if (sym != -1 && symbolAddr[sym] == addr)
+	return symbolName[sym];
+    sprintf(buf, "0x%x", addr);
+    return buf;
+}
+
+//----------------------------------------------------------------------
+// Profile::Print
+// 	Print the flat profile: for each function, the samples taken in
+//	it ("self"), and those taken in it or anything it called
+//	("total"), busiest first.  Then append the call stacks, root
+//	first, to ProfileStacksFile.
+//----------------------------------------------------------------------
+
+void
+Profile::Print()
+{
+    int numRows = 0, maxRows = numPCs;
+    int *rowAddr, *rowSelf, *rowTotal;
+    char buf[20];
+
+    if (numSamples == 0)
+	return;
+
+    for (int h = 0; h < ProfileHashSize; h++)
+	for (ProfileStack *s = stacks[h]; s != NULL; s = s->next)
+	    maxRows += s->depth;
+    rowAddr = new int[maxRows];
+    rowSelf = new int[maxRows];
+    rowTotal = new int[maxRows];
+
+    // "self" from the PC histogram; a row per function (or per PC,
+    // outside every function)
+    for (int i = 0; i < numPCs; i++) {
+	int sym, addr, r;
+
+	if (pcCounts[i] == 0)
+	    continue;
+	sym = FindSymbol(i * 4);
+	addr = (sym == -1) ? i * 4 : symbolAddr[sym];
+	for (r = 0; r < numRows && rowAddr[r] != addr; r++)
+	    ;
+	if (r == numRows) {
+	    rowAddr[r] = addr;
+	    rowSelf[r] = rowTotal[r] = 0;
+	    numRows++;
+	}
+	rowSelf[r] += pcCounts[i];
+    }
+
+    // "total" from the call stacks, counting recursive calls once
+    for (int h = 0; h < ProfileHashSize; h++)
+	for (ProfileStack *s = stacks[h]; s != NULL; s = s->next)
+	    for (int j = 0; j < s->depth; j++) {
+		int k, r;
+
+		for (k = 0; k < j && s->frames[k] != s->frames[j]; k++)
+		    ;
+		if (k < j)
+		    continue;
+		for (r = 0; r < numRows && rowAddr[r] != s->frames[j]; r++)
+		    ;
+		if (r == numRows) {
+		    rowAddr[r] = s->frames[j];
+		    rowSelf[r] = rowTotal[r] = 0;
+		    numRows++;
+		}
+		rowTotal[r] += s->count;
+	    }
+
+    printf("\nProfile of \"%s\": %d samples, one every %d user ticks\n",
+	   name, numSamples, profileInterval);
+    if (numSymbols == 0)
+	printf("(no symbols in %s.coff, so by PC)\n", name);
+    printf("  self%%    self   total  function\n");
+    for (int line = 0; line < numRows; line++) {
+	int best = line;
+
+	// selection sort: busiest (self, then total) first
+	for (int r = line + 1; r < numRows; r++)
+	    if (rowSelf[r] > rowSelf[best] || (rowSelf[r] == rowSelf[best]
+					&& rowTotal[r] > rowTotal[best]))
+		best = r;
+	if (line == MaxFlatLines) {
+	    printf("  ... and %d more\n", numRows - line);
+	    break;
+	}
+	printf("%6.1f%% %7d %7d  %s\n", rowSelf[best] * 100.0 / numSamples,
+	       rowSelf[best], rowTotal[best], Name(rowAddr[best], buf));
+	rowAddr[best] = rowAddr[line];
+	rowSelf[best] = rowSelf[line];
+	rowTotal[best] = rowTotal[line];
+    }
+    delete [] rowAddr;
+    delete [] rowSelf;
+    delete [] rowTotal;
+
+    if (stacksFile == -1) {
+	stacksFile = OpenForWrite(ProfileStacksFile);
+	printf("Call stacks are in %s\n", ProfileStacksFile);
+    }
+    for (int h = 0; h < ProfileHashSize; h++)
+	for (ProfileStack *s = stacks[h]; s != NULL; s = s->next)
+	    PrintStack(stacksFile, s);
+}
+
+//----------------------------------------------------------------------
+// Profile::PrintStack
+// 	Write one line of the collapsed call stacks: the program, then
+//	each frame from the root down, then the count.
+//----------------------------------------------------------------------
+
+void
+Profile::PrintStack(int fd, ProfileStack *stack)
+{
+    char line[MaxProfileDepth * 42 + 64];
+    char buf[20];
+    int len;
+
+    len = sprintf(line, "%.40s", name);
+    for (int i = stack->depth - 1; i >= 0; i--)
+	len += sprintf(line + len, ";%.40s", Name(stack->frames[i], buf));
+    len += sprintf(line + len, " %d\n", stack->count);
+    WriteFile(fd, line, len);
+}
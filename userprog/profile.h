@@ -0,0 +1,96 @@
+// profile.h
+//	Data structures for a sampling profiler of user programs.
+//
+//	With "-prof N", every N ticks of user time the interrupt code
+//	looks at the program counter of the running user program, and
+//	walks its stack to find who called whom.  Each address space
+//	keeps its own Profile: a histogram of the sampled PCs, and a count
+//	of each distinct call stack seen.
+//
+//	Addresses are turned into function names with the symbol table of
+//	the COFF file the program was made from (the NOFF file "name" is
+//	made from "name.coff" by bin/coff2noff, which leaves the symbols
+//	behind).  Only external symbols are used, so the time spent in a
+//	static function shows up in whatever global one precedes it.
+//
+//	There are no frame pointers to follow on the MIPS, so the stack
+//	walk decodes the start of each function to find how big its frame
+//	is and where it saved RetAddrReg, as gdb does for code without
+//	debugging information.
+//
+//	At halt (or when the address space goes away) we print a flat
+//	profile, and append the call stacks to ProfileStacksFile in the
+//	"collapsed" format read by flamegraph.pl:
+//
+//		../test/sort;__start;main;Sort 1234
+//
+// Copyright (c) 1992-1993 The Regents of the University of California.
+// All rights reserved.  See copyright.h for copyright notice and limitation
+// of liability and disclaimer of warranty provisions.
+
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include "copyright.h"
+#include "utility.h"
+
+#define MaxProfileDepth		32	// frames kept per sample
+#define ProfileHashSize		251	// buckets for the call stacks
+#define ProfileStacksFile	"nachos.folded"
+
+// One distinct call stack, and how often it was seen
+
+class ProfileStack {
+  public:
+    int count;				// # samples with this stack
+    int depth;				// # frames in use
+    int frames[MaxProfileDepth];	// leaf first; the start of each
+					// function, or the PC itself if it
+					// isn't in any
+    ProfileStack *next;			// next in the hash bucket
+};
+
+// The following class defines the profile of one user program.
+
+class Profile {
+  public:
+    Profile(char *programName, int size);
+					// Load the symbols of programName,
+					// for an address space of "size" bytes
+    ~Profile();
+
+    void Sample();			// Record where the running
+					// program is now
+    void Print();			// Print the flat profile, and write
+					// out the call stacks
+
+  private:
+    char *name;				// the program's NOFF file
+    int numSamples;
+
+    int *pcCounts;			// samples at each word of the
+    int numPCs;				// address space
+
+    int numSymbols;			// functions in the COFF file,
+    int *symbolAddr;			// sorted by address
+    char **symbolName;
+
+    ProfileStack *stacks[ProfileHashSize];
+
+    void LoadSymbols(char *coffName);	// Fill in the symbol table
+    int FindSymbol(int addr);		// Index of the function holding
+					// addr, -1 if none
+    int Walk(int *frames);		// Walk the stack of the running
+					// program, returning its depth
+    void CountStack(int *frames, int depth);
+    void PrintStack(int fd, ProfileStack *stack);
+    char *Name(int addr, char *buf);	// Symbolic name for addr
+};
+
+extern int profileInterval;		// -prof: user ticks between samples,
+					// 0 if not profiling
+
+extern void ProfileTick(int ticks);	// Take a sample, every
+					// profileInterval ticks
+
+#endif // PROFILE_H
@@ -151,6 +151,7 @@ ConsoleTest (char *in, char *out)
     synchconsole = new SynchConsole(in, out);
     for(;;) {
         ch = synchconsole->GetChar();
+        if(ch == EOF) return;       // end of the input file
         synchconsole->PutChar(ch);
         if(ch == 'q') return;
     }
@@ -33,6 +33,12 @@
 #define SC_Pwd    11
 #define SC_Ls	    12
 #define SC_Cd     13
+#define SC_Pipe   14
+#define SC_PRead  15
+#define SC_PWrite 16
+#define SC_ReadV  17
+#define SC_WriteV 18
+#define SC_GetUsage 19
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 #ifndef IN_ASM
@@ -94,7 +100,9 @@ typedef int OpenFileId;
 void Create(char *name);
 
 /* Open the Nachos file "name", and return an "OpenFileId" that can
- * be used to read and write to the file.
+ * be used to read and write to the file, or -1 if it can't be opened.
+ * Ids are small integers, private to the address space; threads made
+ * with Fork share them, and a program started with Exec inherits them.
  */
 OpenFileId Open(char *name);
 
@@ -133,6 +141,58 @@ void Yield();
 void Pwd();
 void Ls();
 void Cd(char* name);
+
+/* Create a pipe.  fds[0] is set to an OpenFileId for the read end and
+ * fds[1] to one for the write end; both work with Read, Write and
+ * Close.  Read returns 0 once every write end is closed and the pipe
+ * is empty.  Returns 0 on success, -1 on failure.
+ */
+int Pipe(OpenFileId *fds);
+
+/* Positional I/O: like Read and Write, but at byte "offset" of the
+ * file, without using or moving the file's seek position, so threads
+ * sharing an OpenFileId don't race on it.  Files only.
+ */
+int PRead(char *buffer, int size, int offset, OpenFileId id);
+int PWrite(char *buffer, int size, int offset, OpenFileId id);
+
+/* Vectored I/O: read into (write from) "count" buffers in one system
+ * call, in order, as if they were one.  Stops early on a short read
+ * or write.  At most MaxIoVecs buffers.  Returns the total # of bytes.
+ */
+#define MaxIoVecs	16
+
+typedef struct {
+    char *base;		/* start of the buffer */
+    int len;		/* its size in bytes */
+} IoVec;
+
+int ReadV(IoVec *iov, int count, OpenFileId id);
+int WriteV(IoVec *iov, int count, OpenFileId id);
+
+/* Resource accounting: fill in "usage" with what the calling thread
+ * (who = UsageThread) or its whole program, counting the threads that
+ * have finished (who = UsageProgram), has used so far.  Ticks are
+ * simulated time; syscalls[n] counts system calls with code SC_n.
+ * Returns 0 on success, -1 on failure.
+ */
+#define UsageThread	0
+#define UsageProgram	1
+#define UsageSyscalls	32	/* NumSyscallCodes in the kernel */
+
+typedef struct {
+    int userTicks;		/* user instructions executed */
+    int systemTicks;		/* time in the kernel */
+    int voluntarySwitches;	/* context switches because we blocked */
+    int involuntarySwitches;	/* ... while we could have kept running */
+    int pageFaults;
+    int tlbMisses;
+    int sectorsRead;		/* disk sectors read for us */
+    int sectorsWritten;		/* ... and written */
+    int syscalls[UsageSyscalls];
+} Usage;
+
+int GetUsage(int who, Usage *usage);
 /*+++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
 
 #endif /* IN_ASM */